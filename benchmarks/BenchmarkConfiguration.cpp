@@ -0,0 +1,510 @@
+/*
+ * Copyright (C) 2017 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+/*
+  Benchmarks of loading and reading configurations. Every result is printed to
+  the standard output as a single-line JSON object, e.g.
+
+    {"benchmark":"parse","shape":"flat","mbPerSecond":123.4,...}
+
+  so that results of different commits can be compared by a script. The
+  synthetic configurations are generated deterministically into a temporary
+  directory, which is removed afterwards. An optional argument scales the
+  sizes of the generated configurations (default 1).
+*/
+
+#include "../src/Configuration.h"
+#include "../tests/TemporaryDirectory.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <initializer_list>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+
+using sharemind::ByteSize;
+using sharemind::Configuration;
+using sharemind::Path;
+using sharemind::TemporaryDirectory;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/** \brief A deterministic pseudo-random number generator (xorshift64*). */
+class Random {
+
+public: /* Methods: */
+
+    std::uint64_t next() noexcept {
+        m_state ^= m_state >> 12u;
+        m_state ^= m_state << 25u;
+        m_state ^= m_state >> 27u;
+        return m_state * 2685821657736338717u;
+    }
+
+    std::uint64_t below(std::uint64_t const bound) noexcept
+    { return next() % bound; }
+
+private: /* Fields: */
+
+    std::uint64_t m_state = 88172645463325252u;
+
+};
+
+struct Metric {
+    char const * name;
+    double value;
+};
+
+void report(char const * benchmark,
+            char const * shape,
+            char const * variant,
+            std::initializer_list<Metric> metrics)
+{
+    std::printf("{\"benchmark\":\"%s\",\"shape\":\"%s\"", benchmark, shape);
+    if (variant)
+        std::printf(",\"variant\":\"%s\"", variant);
+    for (auto const & metric : metrics)
+        std::printf(",\"%s\":%.6g", metric.name, metric.value);
+    std::printf("}\n");
+    std::fflush(stdout);
+}
+
+double seconds(Clock::duration const d) noexcept
+{ return std::chrono::duration<double>(d).count(); }
+
+/**
+  \brief Calls f() repeatedly for at least the given time.
+  \returns the mean time per call in nanoseconds.
+*/
+template <typename F>
+double nanosecondsPerCall(F && f,
+                          std::chrono::milliseconds const minTime =
+                                  std::chrono::milliseconds(200))
+{
+    std::uint64_t calls = 0u;
+    std::uint64_t batch = 1u;
+    auto const start = Clock::now();
+    Clock::duration elapsed;
+    do {
+        for (auto i = batch; i; --i)
+            f();
+        calls += batch;
+        batch *= 2u;
+        elapsed = Clock::now() - start;
+    } while (elapsed < minTime);
+    return std::chrono::duration<double, std::nano>(elapsed).count()
+           / static_cast<double>(calls);
+}
+
+/* Keeps the compiler from optimizing the benchmarked reads away: */
+volatile std::uint64_t sink;
+
+template <typename T>
+void consume(T const & value) noexcept
+{ sink = sink + static_cast<std::uint64_t>(sizeof(value)); }
+
+void consume(std::string const & value) noexcept { sink = sink + value.size(); }
+
+/** \brief The main file of a generated configuration and its total size. */
+struct GeneratedConfiguration {
+    std::string filename;
+    std::uint64_t bytes = 0u;
+    std::uint64_t keys = 0u;
+};
+
+class Generator {
+
+public: /* Methods: */
+
+    Generator(std::string directory) : m_directory(std::move(directory)) {}
+
+    /** \brief Many small sections with values of mixed types. */
+    GeneratedConfiguration flat(std::size_t const sections,
+                                std::size_t const keysPerSection)
+    {
+        GeneratedConfiguration r;
+        std::string contents;
+        for (std::size_t s = 0u; s < sections; ++s) {
+            contents.append("[Section").append(std::to_string(s)).append("]\n");
+            for (std::size_t k = 0u; k < keysPerSection; ++k)
+                appendMixedValue(contents, k, r);
+        }
+        // Values of known types for measuring reads:
+        contents.append("[Types]\n"
+                        "Int = 123456\n"
+                        "UInt64 = 18446744073709551615\n"
+                        "Double = 3.14159\n"
+                        "String = short\n"
+                        "LongString = a string much too long to be stored "
+                        "inline in std::string\n"
+                        "Interpolated = %{HostName}:%{UserName}\n"
+                        "Size = 64 MiB\n"
+                        "Duration = 1500 ms\n"
+                        "List = 1, 2, 3, 4, 5, 6, 7, 8\n");
+        r.keys += 9u;
+        return writeMain("flat", contents, r);
+    }
+
+    /** \brief A chain of files, each including the next. */
+    GeneratedConfiguration deep(std::size_t const depth,
+                                std::size_t const keysPerFile)
+    {
+        GeneratedConfiguration r;
+        for (std::size_t d = depth; d--;) {
+            std::string contents;
+            contents.append("[Level").append(std::to_string(d)).append("]\n");
+            for (std::size_t k = 0u; k < keysPerFile; ++k)
+                appendMixedValue(contents, k, r);
+            if (d + 1u < depth)
+                contents.append("@include deep")
+                        .append(std::to_string(d + 1u))
+                        .append(".conf\n");
+            writeFile("deep" + std::to_string(d) + ".conf", contents, r);
+        }
+        r.filename = m_directory + "/deep0.conf";
+        return r;
+    }
+
+    /** \brief A single section with very many keys. */
+    GeneratedConfiguration wide(std::size_t const keys) {
+        GeneratedConfiguration r;
+        std::string contents("[Wide]\n");
+        for (std::size_t k = 0u; k < keys; ++k)
+            appendMixedValue(contents, k, r);
+        return writeMain("wide", contents, r);
+    }
+
+    /** \brief Many small files included by a single wildcard directive. */
+    GeneratedConfiguration includeHeavy(std::size_t const files,
+                                        std::size_t const keysPerFile)
+    {
+        GeneratedConfiguration r;
+        auto const directory = m_directory + "/included";
+        if (::mkdir(directory.c_str(), 0700) != 0)
+            throw std::runtime_error("Failed to create directory!");
+        for (std::size_t f = 0u; f < files; ++f) {
+            std::string contents;
+            contents.append("[File").append(std::to_string(f)).append("]\n");
+            for (std::size_t k = 0u; k < keysPerFile; ++k)
+                appendMixedValue(contents, k, r);
+            writeFile("included/" + std::to_string(f) + ".conf", contents, r);
+        }
+        return writeMain("include", "@include included/*.conf\n", r);
+    }
+
+    /** \brief Values full of interpolation variables and escapes. */
+    GeneratedConfiguration interpolationHeavy(std::size_t const keys) {
+        GeneratedConfiguration r;
+        std::string contents("[Interpolated]\n");
+        for (std::size_t k = 0u; k < keys; ++k) {
+            contents.append("Key").append(std::to_string(k))
+                    .append(" = %{HostName}/%{UserName}/")
+                    .append(std::to_string(m_random.below(1000u)))
+                    .append(" %% %{CurrentFileDirectory}/%{HostName}.log\n");
+            ++r.keys;
+        }
+        return writeMain("interpolation", contents, r);
+    }
+
+private: /* Methods: */
+
+    void appendMixedValue(std::string & contents,
+                          std::size_t const k,
+                          GeneratedConfiguration & r)
+    {
+        contents.append("Key").append(std::to_string(k)).append(" = ");
+        switch (m_random.below(4u)) {
+        case 0u:
+            contents.append(std::to_string(m_random.below(1000000u)));
+            break;
+        case 1u:
+            contents.append(m_random.below(2u) ? "true" : "false");
+            break;
+        case 2u:
+            contents.append(std::to_string(m_random.below(64u))).append(" MiB");
+            break;
+        default:
+            contents.append("some string value ")
+                    .append(std::to_string(m_random.next()));
+            break;
+        }
+        contents.push_back('\n');
+        ++r.keys;
+    }
+
+    GeneratedConfiguration & writeMain(std::string const & name,
+                                       std::string const & contents,
+                                       GeneratedConfiguration & r)
+    {
+        writeFile(name + ".conf", contents, r);
+        r.filename = m_directory + '/' + name + ".conf";
+        return r;
+    }
+
+    void writeFile(std::string const & name,
+                   std::string const & contents,
+                   GeneratedConfiguration & r)
+    {
+        std::ofstream out(m_directory + '/' + name, std::ios::binary);
+        out << contents;
+        if (!out)
+            throw std::runtime_error("Failed to write file!");
+        r.bytes += contents.size();
+    }
+
+private: /* Fields: */
+
+    std::string const m_directory;
+    Random m_random;
+
+};
+
+std::shared_ptr<Configuration::Interpolation> newInterpolation() {
+    auto r(std::make_shared<Configuration::Interpolation>());
+    r->addVariable("HostName", "bench.example.com");
+    r->addVariable("UserName", "benchmark");
+    return r;
+}
+
+Configuration load(GeneratedConfiguration const & generated,
+                   Configuration::LoadOptions const & options =
+                           Configuration::LoadOptions())
+{ return Configuration(generated.filename, newInterpolation(), options); }
+
+/**
+  \returns the peak resident set size of a child process loading the given
+           configuration with the given options, and its growth during the
+           load, in KiB.
+*/
+std::pair<long, long> measureLoadRss(
+        GeneratedConfiguration const & generated,
+        Configuration::LoadOptions const & options)
+{
+    int fds[2];
+    if (::pipe(fds) != 0)
+        throw std::runtime_error("pipe() failed!");
+    auto const pid = ::fork();
+    if (pid < 0)
+        throw std::runtime_error("fork() failed!");
+    if (!pid) {
+        ::close(fds[0]);
+        long r[2] = {0, 0};
+        ::rusage usage;
+        if (::getrusage(RUSAGE_SELF, &usage) == 0) {
+            auto const before = usage.ru_maxrss;
+            try {
+                auto const conf(load(generated, options));
+                if (::getrusage(RUSAGE_SELF, &usage) == 0) {
+                    r[0] = usage.ru_maxrss;
+                    r[1] = usage.ru_maxrss - before;
+                }
+            } catch (...) {}
+        }
+        auto const written = ::write(fds[1], r, sizeof(r));
+        ::_exit(written == sizeof(r) ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+    ::close(fds[1]);
+    long r[2] = {0, 0};
+    auto const got = ::read(fds[0], r, sizeof(r));
+    ::close(fds[0]);
+    int status;
+    ::waitpid(pid, &status, 0);
+    if (got != sizeof(r))
+        throw std::runtime_error("Failed to measure RSS!");
+    return {r[0], r[1]};
+}
+
+void benchmarkParse(char const * shape,
+                    GeneratedConfiguration const & generated,
+                    char const * variant = nullptr,
+                    Configuration::LoadOptions const & options =
+                            Configuration::LoadOptions())
+{
+    // Report the best of several loads to reduce noise:
+    Clock::duration best = Clock::duration::max();
+    for (unsigned i = 0u; i < 5u; ++i) {
+        auto const start = Clock::now();
+        auto const conf(load(generated, options));
+        best = std::min(best, Clock::now() - start);
+    }
+    auto const s = seconds(best);
+    auto const rss = measureLoadRss(generated, options);
+    report("parse", shape, variant,
+           {{"bytes", static_cast<double>(generated.bytes)},
+            {"keys", static_cast<double>(generated.keys)},
+            {"seconds", s},
+            {"mbPerSecond", static_cast<double>(generated.bytes) / 1e6 / s},
+            {"keysPerSecond", static_cast<double>(generated.keys) / s},
+            {"peakRssKiB", static_cast<double>(rss.first)},
+            {"rssGrowthKiB", static_cast<double>(rss.second)}});
+}
+
+template <typename T>
+void benchmarkGet(char const * type,
+                  char const * variant,
+                  Configuration const & conf)
+{
+    Path const path(std::string("Types.") + type);
+    auto const typeAndVariant = std::string(type) + '/' + variant;
+    report("get", "flat", typeAndVariant.c_str(),
+           {{"nsPerCall",
+             nanosecondsPerCall([&] { consume(conf.get<T>(path)); })}});
+}
+
+void benchmarkReads(GeneratedConfiguration const & generated) {
+    Configuration conf(load(generated));
+    for (bool const caching : {false, true}) {
+        conf.setParsedValueCaching(caching);
+        auto const variant = caching ? "cached" : "uncached";
+        benchmarkGet<int>("Int", variant, conf);
+        benchmarkGet<std::uint64_t>("UInt64", variant, conf);
+        benchmarkGet<double>("Double", variant, conf);
+        benchmarkGet<std::string>("String", variant, conf);
+        benchmarkGet<std::string>("LongString", variant, conf);
+        benchmarkGet<std::string>("Interpolated", variant, conf);
+        benchmarkGet<ByteSize>("Size", variant, conf);
+        benchmarkGet<std::chrono::milliseconds>("Duration", variant, conf);
+        benchmarkGet<std::vector<int> >("List", variant, conf);
+    }
+    conf.setParsedValueCaching(false);
+
+    Path const typesPath("Types");
+    Path const missingPath("Types.Missing");
+    report("hasValue", "flat", "missing",
+           {{"nsPerCall",
+             nanosecondsPerCall(
+                [&] { consume(conf.hasValue(missingPath)); })}});
+    report("section", "flat", nullptr,
+           {{"nsPerCall",
+             nanosecondsPerCall(
+                [&] { consume(conf.section(typesPath).size()); })}});
+    report("section", "flat", "view",
+           {{"nsPerCall",
+             nanosecondsPerCall(
+                [&] { consume(conf.view().section(typesPath).size()); })}});
+}
+
+void benchmarkIteration(char const * shape,
+                        GeneratedConfiguration const & generated)
+{
+    Configuration const conf(load(generated));
+    std::uint64_t nodes = 0u;
+    for (auto const section : conf)
+        nodes += 1u + section.size();
+    auto const nodesAsDouble = static_cast<double>(nodes);
+    report("iterate", shape, "configuration",
+           {{"nodes", nodesAsDouble},
+            {"nsPerNode",
+             nanosecondsPerCall(
+                [&] {
+                    for (auto const section : conf)
+                        for (auto const child : section)
+                            consume(child.key());
+                }) / nodesAsDouble}});
+    report("iterate", shape, "children",
+           {{"nodes", nodesAsDouble},
+            {"nsPerNode",
+             nanosecondsPerCall(
+                [&] {
+                    for (auto const section : conf.children()) {
+                        auto const sectionConf(section.configuration());
+                        for (auto const child : sectionConf.children())
+                            consume(child.key());
+                    }
+                }) / nodesAsDouble}});
+    report("iterate", shape, "view",
+           {{"nodes", nodesAsDouble},
+            {"nsPerNode",
+             nanosecondsPerCall(
+                [&] {
+                    for (auto const section : conf.view())
+                        for (auto const child : section)
+                            consume(child.key());
+                }) / nodesAsDouble}});
+}
+
+} // anonymous namespace
+
+int main(int argc, char * argv[]) {
+    std::size_t scale = 1u;
+    if (argc > 1) {
+        scale = std::strtoul(argv[1], nullptr, 10);
+        if (!scale) {
+            std::fprintf(stderr, "Usage: %s [scale]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    try {
+        TemporaryDirectory const directory("BenchmarkConfiguration");
+        Generator generator(directory.path());
+        auto const flat = generator.flat(1000u * scale, 20u);
+        auto const deep = generator.deep(64u, 100u * scale);
+        auto const wide = generator.wide(50000u * scale);
+        auto const include = generator.includeHeavy(1000u * scale, 10u);
+        auto const interpolation =
+                generator.interpolationHeavy(20000u * scale);
+
+        benchmarkParse("flat", flat);
+        benchmarkParse("deep", deep);
+        benchmarkParse("wide", wide);
+        benchmarkParse("include", include);
+        {
+            Configuration::LoadOptions options;
+            options.prefetchIncludes = true;
+            benchmarkParse("include", include, "prefetch", options);
+        }
+        {
+            Configuration::LoadOptions options;
+            options.useIoUring = true;
+            benchmarkParse("include", include, "ioUring", options);
+        }
+        benchmarkParse("interpolation", interpolation);
+
+        benchmarkReads(flat);
+        benchmarkIteration("flat", flat);
+        benchmarkIteration("wide", wide);
+        {
+            Configuration const conf(load(interpolation));
+            Path const path("Interpolated.Key0");
+            report("get", "interpolation", nullptr,
+                   {{"nsPerCall",
+                     nanosecondsPerCall(
+                        [&] { consume(conf.get<std::string>(path)); })}});
+        }
+    } catch (std::exception const & e) {
+        std::fprintf(stderr, "Benchmark failed: %s\n", e.what());
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
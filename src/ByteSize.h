@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2017 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#ifndef SHAREMIND_LIBCONFIGURATION_BYTESIZE_H
+#define SHAREMIND_LIBCONFIGURATION_BYTESIZE_H
+
+#include <cstdint>
+
+
+namespace sharemind {
+
+/**
+  \brief A size in bytes, e.g. of a buffer.
+
+  Configuration values of this type consist of a non-negative integer followed
+  by an optional unit suffix. The suffixes "B" (bytes), "KiB", "MiB", "GiB",
+  "TiB", "PiB" and "EiB" denote powers of 1024, and so do their one-letter
+  shorthands "K", "M", "G", "T", "P" and "E". The suffixes "kB", "KB", "MB",
+  "GB", "TB", "PB" and "EB" denote powers of 1000.
+*/
+class ByteSize {
+
+public: /* Types: */
+
+    using ValueType = std::uint64_t;
+
+public: /* Methods: */
+
+    constexpr ByteSize() noexcept : m_bytes(0u) {}
+    constexpr explicit ByteSize(ValueType const bytes) noexcept
+        : m_bytes(bytes)
+    {}
+
+    constexpr ValueType bytes() const noexcept { return m_bytes; }
+
+    constexpr bool operator==(ByteSize const & rhs) const noexcept
+    { return m_bytes == rhs.m_bytes; }
+    constexpr bool operator!=(ByteSize const & rhs) const noexcept
+    { return m_bytes != rhs.m_bytes; }
+    constexpr bool operator<(ByteSize const & rhs) const noexcept
+    { return m_bytes < rhs.m_bytes; }
+    constexpr bool operator<=(ByteSize const & rhs) const noexcept
+    { return m_bytes <= rhs.m_bytes; }
+    constexpr bool operator>(ByteSize const & rhs) const noexcept
+    { return m_bytes > rhs.m_bytes; }
+    constexpr bool operator>=(ByteSize const & rhs) const noexcept
+    { return m_bytes >= rhs.m_bytes; }
+
+private: /* Fields: */
+
+    ValueType m_bytes;
+
+}; /* class ByteSize */
+
+} /* namespace sharemind { */
+
+#endif /* SHAREMIND_LIBCONFIGURATION_BYTESIZE_H */
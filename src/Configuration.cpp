@@ -21,16 +21,23 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <boost/iostreams/stream.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/property_tree/ini_parser.hpp>
 #include <cassert>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <dirent.h>
 #include <fcntl.h>
+#include <fnmatch.h>
+#include <future>
 #include <glob.h>
 #include <limits>
 #include <map>
+#include <mutex>
 #include <new>
-#include <set>
 #include <sharemind/AssertReturn.h>
 #include <sharemind/Concat.h>
 #include <sharemind/Optional.h>
@@ -39,8 +46,15 @@
 #include <sharemind/visibility.h>
 #include <streambuf>
 #include <sys/stat.h>
+#include <sys/syscall.h>
 #include <system_error>
+#include <thread>
 #include <unistd.h>
+#include <unordered_map>
+#include <unordered_set>
+#include "FilePrefetcher_p.h"
+#include "IoUringFileLoader_p.h"
+#include "ValueHandler_p.h"
 #include "XdgBaseDirectory.h"
 
 
@@ -70,6 +84,70 @@ struct ConfigurationFileContextInfo {
     LineNumber const m_lineNumber;
 };
 
+/** \returns the heap memory owned by the given object, excluding itself. */
+template <typename T>
+constexpr inline std::size_t heapUsage(T const &) noexcept { return 0u; }
+
+inline std::size_t heapUsage(std::string const & s) noexcept {
+    // Short strings are stored inline:
+    static std::size_t const inlineCapacity = std::string().capacity();
+    return (s.capacity() > inlineCapacity) ? s.capacity() + 1u : 0u;
+}
+
+template <typename T>
+std::size_t heapUsage(std::vector<T> const & v) noexcept {
+    auto r = v.capacity() * sizeof(T);
+    for (auto const & e : v)
+        r += heapUsage(e);
+    return r;
+}
+
+/* The approximate size of the control block of std::make_shared(): */
+constexpr std::size_t const sharedControlBlockSize = 2u * sizeof(void *);
+
+struct CachedValueBase {
+
+    CachedValueBase(void const * const type) noexcept : m_type(type) {}
+    virtual ~CachedValueBase() noexcept {}
+
+    /** \returns the memory used by this cached value, including itself. */
+    virtual std::size_t memoryUsage() const noexcept = 0;
+
+    void const * const m_type;
+    CachedValueBase * m_next = nullptr;
+
+};
+
+template <typename T>
+struct CachedValue final: CachedValueBase {
+
+    CachedValue(T value)
+            noexcept(std::is_nothrow_move_constructible<T>::value)
+        : CachedValueBase(&typeTag)
+        , m_value(std::move(value))
+    {}
+
+    std::size_t memoryUsage() const noexcept final override
+    { return sizeof(*this) + heapUsage(m_value); }
+
+    T const m_value;
+    static char const typeTag;
+
+};
+
+template <typename T>
+char const CachedValue<T>::typeTag = '\0';
+
+/**
+  \returns the lock guarding the latest interpolated value of the given value
+           item. The locks are striped by the address of the item.
+*/
+std::mutex & interpolatedValueLock(void const * const item) noexcept {
+    static std::array<std::mutex, 64u> locks;
+    return locks[(reinterpret_cast<std::uintptr_t>(item) / 16u)
+                 % locks.size()];
+}
+
 struct ValueItem {
 
     ValueItem(std::string value,
@@ -80,15 +158,77 @@ struct ValueItem {
                             std::shared_ptr<std::string> >::value
                      && std::is_nothrow_move_constructible<LineNumber>::value)
         : m_value(std::move(value))
+        , m_needsInterpolation(m_value.find('%') != std::string::npos)
         , m_context(std::move(filename), std::move(lineNumber))
     {}
 
     ValueItem(ValueItem &&) = delete;
     ValueItem(ValueItem const &) = delete;
 
+    ~ValueItem() noexcept {
+        for (auto * c = m_cache.load(std::memory_order_acquire); c;) {
+            auto * const next = c->m_next;
+            delete c;
+            c = next;
+        }
+    }
+
     ValueItem & operator=(ValueItem &&) = delete;
     ValueItem & operator=(ValueItem const &) = delete;
 
+    /** \returns the cached parsed value of type T, if present. */
+    template <typename T>
+    T const * cachedValue() const noexcept {
+        return findCachedValue<T>(m_cache.load(std::memory_order_acquire));
+    }
+
+    /**
+      \brief Caches the given parsed value of type T, unless another thread
+             managed to cache a value of the same type first.
+      \returns a reference to the cached value.
+    */
+    template <typename T>
+    T const & cacheValue(T value) const {
+        auto newCache(std::make_unique<CachedValue<T> >(std::move(value)));
+        auto * head = m_cache.load(std::memory_order_acquire);
+        do {
+            if (auto const * const cached = findCachedValue<T>(head))
+                return *cached;
+            newCache->m_next = head;
+        } while (!m_cache.compare_exchange_weak(head,
+                                                newCache.get(),
+                                                std::memory_order_acq_rel,
+                                                std::memory_order_acquire));
+        return newCache.release()->m_value;
+    }
+
+    template <typename T>
+    static T const * findCachedValue(CachedValueBase const * c) noexcept {
+        for (; c; c = c->m_next)
+            if (c->m_type == &CachedValue<T>::typeTag)
+                return &static_cast<CachedValue<T> const *>(c)->m_value;
+        return nullptr;
+    }
+
+    /**
+      \returns the heap memory used by the value and the cached parsed and
+               interpolated values.
+    */
+    std::size_t memoryUsage() const noexcept {
+        auto r = heapUsage(m_value);
+        for (auto const * c = m_cache.load(std::memory_order_acquire);
+             c;
+             c = c->m_next)
+            r += c->memoryUsage();
+        if (m_needsInterpolation) {
+            std::lock_guard<std::mutex> const guard(
+                        interpolatedValueLock(this));
+            if (m_interpolated)
+                r += sizeof(std::string) + heapUsage(*m_interpolated);
+        }
+        return r;
+    }
+
     std::string interpolated(Configuration::Interpolation const & interpolation)
             const
     {
@@ -103,8 +243,123 @@ struct ValueItem {
         }
     }
 
+    /**
+      \returns a view of the interpolated value. Only the latest result of
+               interpolation is stored, hence the view remains valid until
+               the value is interpolated to a different result, i.e. after
+               the interpolation has been modified.
+    */
+    StringView interpolatedView(
+            Configuration::Interpolation const & interpolation) const
+    {
+        std::string value(interpolated(interpolation));
+        std::lock_guard<std::mutex> const guard(interpolatedValueLock(this));
+        if (!m_interpolated) {
+            m_interpolated = std::make_unique<std::string>(std::move(value));
+        } else if (*m_interpolated != value) {
+            *m_interpolated = std::move(value);
+        }
+        return *m_interpolated;
+    }
+
     std::string const m_value;
+
+    /* Whether interpolation might change the value, in which case parsed
+       values are never cached: */
+    bool const m_needsInterpolation;
+
     ConfigurationFileContextInfo const m_context;
+
+    /* A lock-free list of parsed values of distinct types: */
+    mutable std::atomic<CachedValueBase *> m_cache{nullptr};
+
+    /* The latest interpolated value referred to by views, guarded by
+       interpolatedValueLock(this): */
+    mutable std::unique_ptr<std::string> m_interpolated;
+};
+
+/** \brief The type of the (private) Configuration::ptree. */
+using Tree = boost::property_tree::basic_ptree<std::string,
+                                               std::shared_ptr<void> >;
+
+/**
+  \brief Hash indexes of the children of nodes with many children, used for
+         lookups instead of the ordered index of the tree. Iteration still
+         uses the tree, hence preserves declaration order.
+*/
+class WideNodeIndexes {
+
+public: /* Types: */
+
+    using ChildMap = StringHashMap<Tree::value_type const *, StringView>;
+
+public: /* Methods: */
+
+    /** \returns whether the children of the given node are to be hashed. */
+    static bool isWide(Tree const & node) noexcept
+    { return node.size() >= minChildren; }
+
+    /** \returns the hash index of the children of the node, if any. */
+    ChildMap const * find(Tree const & node) const noexcept {
+        if (!isWide(node))
+            return nullptr;
+        auto const it(m_indexes.find(&node));
+        return (it != m_indexes.end()) ? &it->second : nullptr;
+    }
+
+    /** \brief (Re)builds the hash index of the node, if it is wide. */
+    void index(Tree const & node) {
+        if (!isWide(node)) {
+            unindex(node);
+            return;
+        }
+        auto & map = m_indexes[&node];
+        map.clear();
+        map.reserve(node.size());
+        for (auto const & child : node)
+            map.tryEmplace(StringView(child.first), &child);
+    }
+
+    void unindex(Tree const & node) noexcept { m_indexes.erase(&node); }
+
+    /**
+      \brief Removes the given key from the hash index of the node, if any.
+      \note Must be called before erasing the children with the key from the
+            node, as the index refers to the keys of the children.
+    */
+    void eraseKey(Tree const & node, StringView key) noexcept {
+        auto const it(m_indexes.find(&node));
+        if (it != m_indexes.end())
+            it->second.erase(key);
+    }
+
+    /** \returns the memory used by the hash index of the given node. */
+    std::size_t memoryUsage(Tree const & node) const noexcept {
+        auto const it(m_indexes.find(&node));
+        if (it == m_indexes.end())
+            return 0u;
+        return sizeof(*it) + 2u * sizeof(void *)
+               + it->second.allocatedBytes();
+    }
+
+    std::size_t bucketMemoryUsage() const noexcept
+    { return m_indexes.bucket_count() * sizeof(void *); }
+
+private: /* Fields: */
+
+    static constexpr std::size_t const minChildren = 64u;
+
+    std::unordered_map<Tree const *, ChildMap> m_indexes;
+
+};
+
+constexpr std::size_t const WideNodeIndexes::minChildren;
+
+struct ReadContext {
+    Configuration::Interpolation const * interpolation;
+    bool cacheParsedValues;
+    bool trackAccesses;
+    WideNodeIndexes const * wideNodes;
 };
 
 class TreeItem {
@@ -138,11 +393,23 @@ public: /* Methods: */
     void eraseValueItem() noexcept { m_valueItem.reset(); }
     void eraseSectionItem() noexcept { m_haveSectionItem = false; }
 
+    void countAccess() const noexcept
+    { m_accessCount.fetch_add(1u, std::memory_order_relaxed); }
+
+    std::uint64_t accessCount() const noexcept
+    { return m_accessCount.load(std::memory_order_relaxed); }
+
+    void resetAccessCount() const noexcept
+    { m_accessCount.store(0u, std::memory_order_relaxed); }
+
 private: /* Fields: */
 
     Optional<ValueItem> m_valueItem;
     bool m_haveSectionItem;
 
+    /* Number of reads of this node while access tracking was enabled: */
+    mutable std::atomic<std::uint64_t> m_accessCount{0u};
+
 };
 
 inline TreeItem & getTreeItem(std::shared_ptr<void> const & ptr) noexcept
@@ -182,16 +449,48 @@ struct FileId {
     decltype(::stat::st_ino) inode;
 };
 
-inline constexpr bool operator<(FileId const & lhs, FileId const & rhs) noexcept
-{
-    if (lhs.deviceId < rhs.deviceId)
-        return true;
-    if (rhs.deviceId < lhs.deviceId)
-        return false;
-    return lhs.inode < rhs.inode;
+inline constexpr bool operator==(FileId const & lhs, FileId const & rhs)
+        noexcept
+{ return (lhs.deviceId == rhs.deviceId) && (lhs.inode == rhs.inode); }
+
+struct FileIdHash {
+    std::size_t operator()(FileId const & fileId) const noexcept {
+        return std::hash<std::uint64_t>()(
+                    (static_cast<std::uint64_t>(fileId.deviceId)
+                     * 0x9e3779b97f4a7c15u)
+                    ^ static_cast<std::uint64_t>(fileId.inode));
+    }
+};
+
+using LoadClock = std::chrono::steady_clock;
+
+/** \brief Adds the time of its lifetime to the given duration. */
+class PhaseTimer {
+
+public: /* Methods: */
+
+    PhaseTimer(std::chrono::nanoseconds & total) noexcept
+        : m_total(total)
+        , m_start(LoadClock::now())
+    {}
+
+    PhaseTimer(PhaseTimer &&) = delete;
+    PhaseTimer(PhaseTimer const &) = delete;
+
+    ~PhaseTimer() noexcept { m_total += LoadClock::now() - m_start; }
+
+    PhaseTimer & operator=(PhaseTimer &&) = delete;
+    PhaseTimer & operator=(PhaseTimer const &) = delete;
+
+private: /* Fields: */
+
+    std::chrono::nanoseconds & m_total;
+    LoadClock::time_point const m_start;
+
 };
 
-class PosixFileInputSource {
+/** \brief Reads a file, or returns its contents if preloaded. */
+class FileInputSource {
 
 public: /* Types: */
 
@@ -200,8 +499,10 @@ public: /* Types: */
 
 public: /* Methods: */
 
-    PosixFileInputSource(std::string const & filename)
-        : m_fd(
+    FileInputSource(std::string const & filename,
+                    std::chrono::nanoseconds & readTime)
+        : m_readTime(&readTime)
+        , m_fd(
             std::shared_ptr<int>(
                 new int(
                     [&filename]() {
@@ -216,6 +517,12 @@ public: /* Methods: */
                 }))
     {}
 
+    FileInputSource(std::shared_ptr<std::string const> contents,
+                    FileId const fileId) noexcept
+        : m_contents(std::move(contents))
+        , m_fileId(fileId)
+    {}
+
     std::streamsize read(char * const buffer, std::streamsize const bufferSize)
     {
         assert(bufferSize >= 0);
@@ -223,7 +530,20 @@ public: /* Methods: */
             return 0;
         using US = std::make_unsigned<std::streamsize>::type;
         std::size_t const readSize = capMaxToSizeT(static_cast<US>(bufferSize));
-        auto const r = ::read(*m_fd, buffer, readSize);
+        if (m_contents) {
+            assert(m_contentsPos <= m_contents->size());
+            auto const size = std::min(readSize,
+                                       m_contents->size() - m_contentsPos);
+            if (!size)
+                return -1;
+            std::memcpy(buffer, m_contents->data() + m_contentsPos, size);
+            m_contentsPos += size;
+            return static_cast<std::streamsize>(size);
+        }
+        auto const r = [&]() {
+            PhaseTimer const timer(*m_readTime);
+            return ::read(*m_fd, buffer, readSize);
+        }();
         if (r > 0u)
             return r;
         if (r == 0u)
@@ -232,7 +552,21 @@ public: /* Methods: */
         throw std::system_error(errno, std::system_category());
     }
 
+    /** \returns the size of the file, if known, otherwise zero. */
+    std::uint64_t size() const {
+        if (m_contents)
+            return m_contents->size();
+        struct ::stat fileStat;
+        if (::fstat(*m_fd, &fileStat))
+            throw std::system_error(errno, std::system_category());
+        return (fileStat.st_size > 0)
+               ? static_cast<std::uint64_t>(fileStat.st_size)
+               : 0u;
+    }
+
     FileId fileId() const {
+        if (m_contents)
+            return m_fileId;
         struct ::stat fileStat;
         if (auto const r = ::fstat(*m_fd, &fileStat))
             throw std::system_error(errno, std::system_category());
@@ -244,17 +578,64 @@ public: /* Methods: */
 
 private: /* Fields: */
 
+    std::chrono::nanoseconds * m_readTime = nullptr;
     std::shared_ptr<int> m_fd;
+    std::shared_ptr<std::string const> m_contents;
+    std::size_t m_contentsPos = 0u;
+    FileId m_fileId{};
 
 };
 
+/**
+  \brief Like std::getline(in, line), but throws LineTooLongException as soon
+         as the line exceeds the given length, without reading any further.
+*/
+inline void getLineWithLimit(std::istream & in,
+                             std::string & line,
+                             std::size_t const maxLength)
+{
+    using Traits = std::istream::traits_type;
+    line.clear();
+    std::istream::sentry const sentry(in, true);
+    if (!sentry)
+        return;
+    auto & buffer = *in.rdbuf();
+    for (;;) {
+        Traits::int_type c;
+        try {
+            c = buffer.sbumpc();
+        } catch (...) {
+            // Like std::getline(), report read errors by setting badbit:
+            in.setstate(std::ios_base::badbit);
+            return;
+        }
+        if (Traits::eq_int_type(c, Traits::eof())) {
+            in.setstate(line.empty()
+                        ? (std::ios_base::eofbit | std::ios_base::failbit)
+                        : std::ios_base::eofbit);
+            return;
+        }
+        if (Traits::to_char_type(c) == '\n')
+            return;
+        if (line.size() >= maxLength)
+            throw Configuration::LineTooLongException();
+        line.push_back(Traits::to_char_type(c));
+    }
+}
+
 template <typename Ptree>
 struct TopLevelParseState;
 
 struct FileParseJob {
     struct ParseState {
-        ParseState(boost::filesystem::path const & path)
-            : m_inFile(path.string())
+        ParseState(boost::filesystem::path const & path,
+                   std::chrono::nanoseconds & readTime)
+            : m_inFile(path.string(), readTime)
+        {}
+
+        ParseState(std::shared_ptr<std::string const> contents,
+                   FileId const fileId) noexcept
+            : m_inFile(std::move(contents), fileId)
         {}
 
         ParseState(ParseState &&) = delete;
@@ -267,16 +648,13 @@ struct FileParseJob {
         std::string parseFile(TopLevelParseState<Ptree> & tls,
                               FileParseJob const & fpj);
 
-        PosixFileInputSource m_inFile;
-        boost::iostreams::stream<PosixFileInputSource> m_inStream{m_inFile};
+        FileInputSource m_inFile;
+        boost::iostreams::stream<FileInputSource> m_inStream{m_inFile};
         LineNumber m_lineNumber{1u};
+        std::uint64_t m_bytesRead = 0u;
     };
 
-    FileParseJob(boost::filesystem::path const & path)
-        : m_canonicalPath(
-              std::make_shared<boost::filesystem::path>(
-                  boost::filesystem::canonical(path)))
-    {}
+    FileParseJob() noexcept {}
 
     FileParseJob(FileParseJob &&) = delete;
     FileParseJob(FileParseJob const &) = delete;
@@ -284,6 +662,18 @@ struct FileParseJob {
     FileParseJob & operator=(FileParseJob &&) = delete;
     FileParseJob & operator=(FileParseJob const &) = delete;
 
+    /** \brief Prepares this (possibly recycled) job to parse another file. */
+    void reset(std::shared_ptr<boost::filesystem::path const> canonicalPath,
+               std::shared_ptr<std::string const> preloadedContents,
+               FileId const preloadedFileId) noexcept
+    {
+        m_canonicalPath = std::move(canonicalPath);
+        m_escapedCurrentFileDirectory.reset();
+        m_state.reset();
+        m_preloadedContents = std::move(preloadedContents);
+        m_preloadedFileId = preloadedFileId;
+    }
+
     template <typename Ptree>
     std::string parseFile(TopLevelParseState<Ptree> & tls);
 
@@ -313,10 +703,17 @@ struct FileParseJob {
         }
     }
 
-    std::shared_ptr<boost::filesystem::path const> const m_canonicalPath;
+    std::shared_ptr<boost::filesystem::path const> m_canonicalPath;
     mutable Optional<std::string> m_escapedCurrentFileDirectory;
-    std::unique_ptr<FileParseJob> m_prev;
     Optional<ParseState> m_state;
+    std::size_t m_includeDepth = 0u;
+
+    // Index of the statistics of this file, if collected:
+    std::size_t m_statisticsIndex = 0u;
+
+    // Contents of the file, if preloaded:
+    std::shared_ptr<std::string const> m_preloadedContents;
+    FileId m_preloadedFileId{};
 };
 
 
@@ -365,29 +762,309 @@ std::string FileParseJob::prepareValue(StringView s) const {
     return r.append(s.data(), s.size());
 }
 
+/** \brief A file to be parsed once the files above it on the stack are done. */
+struct PendingInclude {
+    std::string path;
+    bool pathIsCanonical = false;
+    std::size_t includeDepth = 0u;
+
+    // Contents of the file, if preloaded:
+    std::shared_ptr<std::string const> contents;
+    FileId fileId{};
+};
+
+/**
+  \brief Expands the given @include pattern using glob(), sorting the results
+         without regard to LC_COLLATE.
+*/
+void globIncludes(std::string const & pattern,
+                  std::vector<PendingInclude> & includes)
+{
+    ::glob_t globResults;
+    auto const r = ::glob(pattern.c_str(),
+                          GLOB_ERR | GLOB_NOCHECK | GLOB_NOSORT,
+                          nullptr,
+                          &globResults);
+    if (r != 0) {
+        if (r == GLOB_NOSPACE)
+            throw std::bad_alloc();
+        throw Configuration::GlobException();
+    }
+    try {
+        includes.resize(globResults.gl_pathc);
+        for (std::size_t i = 0u; i < globResults.gl_pathc; ++i)
+            includes[i].path = globResults.gl_pathv[i];
+    } catch (...) {
+        ::globfree(&globResults);
+        throw;
+    }
+    ::globfree(&globResults);
+    std::sort(includes.begin(),
+              includes.end(),
+              [](PendingInclude const & lhs, PendingInclude const & rhs)
+                      noexcept
+              { return lhs.path < rhs.path; });
+}
+
+/**
+  \brief Expands the given @include pattern like globIncludes(), provided
+         that its wildcards are all in the last path component, by reading the
+         directory entries directly with getdents64(). This scales to large
+         conf.d directories, as the matching names are collected into a single
+         buffer and sorted by views into it, and the canonical paths of regular
+         files are derived from that of the directory instead of resolving
+         each of them separately.
+  \returns whether the pattern was expanded. If not, e.g. because the pattern
+           has wildcards in the directory part, the directory could not be
+           read or nothing matched, globIncludes() is to be used instead.
+*/
+bool listDirectoryIncludes(std::string const & pattern,
+                           std::vector<PendingInclude> & includes)
+{
+    assert(!pattern.empty());
+    assert(pattern.front() == '/');
+    auto const namePos = pattern.rfind('/') + 1u;
+    auto const namePattern = pattern.c_str() + namePos;
+    if (!std::strpbrk(namePattern, "*?[")
+        || (pattern.find_first_of("*?[\\") < namePos))
+        return false;
+
+    std::string const directory(pattern, 0u, namePos);
+    auto const fd = ::open(directory.c_str(),
+                           O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+
+    struct Entry {
+        std::size_t offset;
+        std::size_t size;
+        unsigned char type;
+    };
+    std::string names;
+    std::vector<Entry> entries;
+    try {
+        constexpr static std::size_t const bufferSize = 65536u;
+        std::unique_ptr<char[]> const buffer(new char[bufferSize]);
+        for (;;) {
+            auto const r = ::syscall(SYS_getdents64,
+                                     fd,
+                                     buffer.get(),
+                                     bufferSize);
+            if (r <= 0) {
+                if (r < 0) {
+                    ::close(fd);
+                    return false;
+                }
+                break;
+            }
+            for (long pos = 0; pos < r;) {
+                auto const & d =
+                        *reinterpret_cast<struct ::dirent64 const *>(
+                            buffer.get() + pos);
+                pos += d.d_reclen;
+                if (::fnmatch(namePattern, d.d_name, FNM_PERIOD) != 0)
+                    continue;
+                auto const size = std::strlen(d.d_name);
+                entries.emplace_back(Entry{names.size(), size, d.d_type});
+                names.append(d.d_name, size);
+            }
+        }
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+    ::close(fd);
+    if (entries.empty())
+        return false;
+
+    auto const nameOf =
+            [&names](Entry const & e) noexcept
+            { return StringView(names.data() + e.offset, e.size); };
+    std::sort(entries.begin(),
+              entries.end(),
+              [&nameOf](Entry const & lhs, Entry const & rhs) noexcept {
+                  auto const l(nameOf(lhs));
+                  auto const r(nameOf(rhs));
+                  auto const c = std::memcmp(l.data(),
+                                             r.data(),
+                                             std::min(l.size(), r.size()));
+                  return (c < 0) || ((c == 0) && (l.size() < r.size()));
+              });
+
+    Optional<std::string> canonicalDirectory;
+    try {
+        auto & cd = canonicalDirectory.emplace(
+                        boost::filesystem::canonical(directory).string());
+        if (cd.empty() || (cd.back() != '/'))
+            cd.push_back('/');
+    } catch (boost::filesystem::filesystem_error const &) {
+        canonicalDirectory.reset();
+    }
+
+    includes.resize(entries.size());
+    for (std::size_t i = 0u; i < entries.size(); ++i) {
+        auto const name(nameOf(entries[i]));
+        auto & include = includes[i];
+        if (canonicalDirectory.hasValue() && (entries[i].type == DT_REG)) {
+            include.path.reserve(canonicalDirectory->size() + name.size());
+            include.path.assign(*canonicalDirectory)
+                        .append(name.data(), name.size());
+            include.pathIsCanonical = true;
+        } else {
+            include.path.reserve(directory.size() + name.size());
+            include.path.assign(directory).append(name.data(), name.size());
+        }
+    }
+    return true;
+}
+
 template <typename Ptree>
 struct TopLevelParseState {
 
-    TopLevelParseState(Ptree & ptree)
+    TopLevelParseState(Ptree & ptree,
+                       Configuration::LoadOptions const & options,
+                       Configuration::LoadTimings & timings,
+                       Configuration::LoadStatistics & statistics)
         : m_result(ptree)
+        , m_options(options)
+        , m_timings(timings)
+        , m_statistics(options.collectStatistics ? &statistics : nullptr)
     {}
 
-    void pushJob(boost::filesystem::path const & boostPath) {
-        auto fileParseJob(std::make_unique<FileParseJob>(boostPath));
-        fileParseJob->m_prev = std::move(m_fileParseJob);
-        m_fileParseJob = std::move(fileParseJob);
+    void checkCancelled() const {
+        auto const & flag = m_options.cancellationFlag;
+        if (flag && flag->load(std::memory_order_relaxed))
+            throw Configuration::LoadCancelledException();
+    }
+
+    bool empty() const noexcept { return m_stack.empty(); }
+
+    void pushInclude(PendingInclude include)
+    { m_stack.emplace_back(StackEntry{std::move(include), nullptr}); }
+
+    /** \returns the job for the topmost file, starting it if necessary. */
+    FileParseJob & topJob() {
+        assert(!m_stack.empty());
+        auto & entry = m_stack.back();
+        if (entry.job)
+            return *entry.job;
+
+        auto & include = entry.include;
+        std::shared_ptr<boost::filesystem::path const> canonicalPath;
+        if (include.pathIsCanonical) {
+            canonicalPath = std::make_shared<boost::filesystem::path const>(
+                                std::move(include.path));
+        } else {
+            PhaseTimer const timer(m_timings.canonicalize);
+            canonicalPath = std::make_shared<boost::filesystem::path const>(
+                                boost::filesystem::canonical(include.path));
+        }
+        std::unique_ptr<FileParseJob> job;
+        if (m_freeJobs.empty()) {
+            job = std::make_unique<FileParseJob>();
+        } else {
+            job = std::move(m_freeJobs.back());
+            m_freeJobs.pop_back();
+        }
+        job->reset(std::move(canonicalPath),
+                   std::move(include.contents),
+                   include.fileId);
+        job->m_includeDepth = include.includeDepth;
+        if (m_statistics) {
+            auto & files = m_statistics->files;
+            job->m_statisticsIndex = files.size();
+            files.emplace_back();
+            files.back().path = job->m_canonicalPath->string();
+            files.back().includeDepth = include.includeDepth;
+        }
+        entry.job = std::move(job);
+        return *entry.job;
+    }
+
+    /** \returns the statistics of the file of the given job, if collected. */
+    Configuration::LoadedFileStatistics * fileStatistics(
+            FileParseJob const & job) const noexcept
+    {
+        if (!m_statistics)
+            return nullptr;
+        assert(job.m_statisticsIndex < m_statistics->files.size());
+        return &m_statistics->files[job.m_statisticsIndex];
+    }
+
+    /**
+      \brief Opens the given top-level section for appending, creating it if
+             it does not yet exist.
+    */
+    void openSection(std::string const & name) {
+        auto const hash = stringHash(name);
+        auto * child = m_rootIndex.children.find(name, hash);
+        if (!child) {
+            auto const it(m_result.push_back(
+                              std::make_pair(
+                                  name,
+                                  Ptree(std::make_shared<TreeItem>()))));
+            child = m_rootIndex.children.tryEmplaceHashed(
+                        StringView(it->first),
+                        hash,
+                        it->second).first;
+        }
+        assert(child->node->data()); // Nothing erased yet
+        auto & t = getTreeItem(child->node->data());
+        if (!t.hasSectionItem())
+            t.initializeSectionItem();
+        if (!child->sectionIndex)
+            child->sectionIndex = std::make_unique<KeyIndex>();
+        m_currentSection = child->node;
+        m_currentIndex = child->sectionIndex.get();
+    }
+
+    void openTopLevel() noexcept {
+        m_currentSection = nullptr;
+        m_currentIndex = &m_rootIndex;
     }
 
     void popJob() noexcept {
-        assert(m_fileParseJob);
-        m_fileParseJob =
-                decltype(m_fileParseJob)(std::move(m_fileParseJob->m_prev));
+        assert(!m_stack.empty());
+        assert(m_stack.back().job);
+        auto job(std::move(m_stack.back().job));
+        m_stack.pop_back();
+        job->reset(nullptr, nullptr, FileId{});
+        try {
+            m_freeJobs.emplace_back(std::move(job));
+        } catch (...) {}
     }
 
+    struct StackEntry {
+        PendingInclude include;
+        std::unique_ptr<FileParseJob> job;
+    };
+
+    /**
+      \brief A hash index of the children of a node, used while loading instead
+             of the ordered index of the tree to find duplicate keys and
+             reopened sections. Its keys refer to the keys stored in the tree.
+    */
+    struct KeyIndex {
+        struct Child {
+            explicit Child(Ptree & node_) noexcept : node(&node_) {}
+
+            Ptree * node;
+            std::unique_ptr<KeyIndex> sectionIndex;
+        };
+
+        StringHashMap<Child, StringView> children;
+    };
+
     Ptree & m_result;
+    Configuration::LoadOptions const & m_options;
+    Configuration::LoadTimings & m_timings;
+    Configuration::LoadStatistics * const m_statistics;
     Ptree * m_currentSection = nullptr;
-    std::unique_ptr<FileParseJob> m_fileParseJob;
-    std::set<FileId> m_visitedFiles;
+    KeyIndex m_rootIndex;
+    KeyIndex * m_currentIndex = &m_rootIndex;
+    std::vector<StackEntry> m_stack;
+    std::vector<std::unique_ptr<FileParseJob> > m_freeJobs;
+    std::unordered_set<FileId, FileIdHash> m_visitedFiles;
 };
 
 template <typename Ptree>
@@ -397,10 +1074,31 @@ std::string FileParseJob::ParseState::parseFile(TopLevelParseState<Ptree> & tls,
     constexpr static auto const whitespace = " \t\n\r"_sv;
     std::string line;
     std::string currentSectionName;
+    std::size_t linesUntilCancellationCheck = 1024u;
+    auto * const statistics = tls.fileStatistics(fpj);
+    auto const & options = tls.m_options;
+    bool const limitLineLength =
+            options.maxLineLength < std::numeric_limits<std::size_t>::max();
     for (; m_inStream.good(); ++m_lineNumber) {
-        std::getline(m_inStream, line);
+        if (!--linesUntilCancellationCheck) {
+            tls.checkCancelled();
+            linesUntilCancellationCheck = 1024u;
+        }
+        if (limitLineLength) {
+            getLineWithLimit(m_inStream, line, options.maxLineLength);
+        } else {
+            std::getline(m_inStream, line);
+        }
         if (!m_inStream.good() && !m_inStream.eof())
             throw Configuration::FileReadException();
+        bool const hasNewline = !m_inStream.eof();
+        m_bytesRead += line.size() + hasNewline;
+        if (m_bytesRead > options.maxFileSize)
+            throw Configuration::FileTooLargeException();
+        if (statistics && (hasNewline || !line.empty())) {
+            ++statistics->lines;
+            statistics->bytes += line.size() + hasNewline;
+        }
 
         // Ignore empty lines and comments:
         if (line.empty() || line.front() == ';')
@@ -414,6 +1112,8 @@ std::string FileParseJob::ParseState::parseFile(TopLevelParseState<Ptree> & tls,
                 throw Configuration::InvalidSyntaxException();
             if (directive != "include"_sv)
                 throw Configuration::UnknownDirectiveException();
+            if (fpj.m_includeDepth >= options.maxIncludeDepth)
+                throw Configuration::IncludeTooDeepException();
             if (whitespacePos == StringView::npos)
                 throw Configuration::IncludeDirectiveMissingArgumentException();
             auto arg(lv.substr(whitespacePos + 1u).trimmed(whitespace));
@@ -430,26 +1130,12 @@ std::string FileParseJob::ParseState::parseFile(TopLevelParseState<Ptree> & tls,
                 throw Configuration::InvalidSyntaxException();
             currentSectionName =
                     lv.substr(1, end - 1).trimmed(whitespace).str();
+            if (statistics)
+                ++statistics->sections;
             if (currentSectionName.empty()) {
-                tls.m_currentSection = nullptr;
+                tls.openTopLevel();
             } else {
-                auto keyStr(currentSectionName);
-                auto const sectionIt(tls.m_result.find(keyStr));
-                if (sectionIt != tls.m_result.not_found()) {
-                    assert(sectionIt->second.data()); // Nothing erased yet
-                    auto & t = getTreeItem(sectionIt->second.data());
-                    if (!t.hasSectionItem())
-                        t.initializeSectionItem();
-                    tls.m_currentSection = &sectionIt->second;
-                } else {
-                    auto treeItem = std::make_shared<TreeItem>();
-                    treeItem->initializeSectionItem();
-                    tls.m_currentSection =
-                            &tls.m_result.push_back(
-                                std::make_pair(
-                                    std::move(keyStr),
-                                    Ptree(std::move(treeItem))))->second;
-                }
+                tls.openSection(currentSectionName);
             }
         } else { // Parse key-value pairs:
             auto const sepPos(lv.find('='));
@@ -457,19 +1143,19 @@ std::string FileParseJob::ParseState::parseFile(TopLevelParseState<Ptree> & tls,
                 throw Configuration::InvalidSyntaxException();
             auto const key(lv.substr(0u, sepPos).rightTrimmed(whitespace));
             assert(!key.empty());
-            auto keyStr(key.str());
-
-            auto & container =
-                    tls.m_currentSection ? *tls.m_currentSection : tls.m_result;
-            auto const it(container.find(keyStr));
-            if (it != container.not_found()) {
-                assert(it->second.data()); // Nothing erased yet
-                auto & t = getTreeItem(it->second.data());
+            if (statistics)
+                ++statistics->keys;
+
+            auto const hash = stringHash(key);
+            auto & index = tls.m_currentIndex->children;
+            if (auto const * const child = index.find(key, hash)) {
+                assert(child->node->data()); // Nothing erased yet
+                auto & t = getTreeItem(child->node->data());
                 if (t.hasValueItem()) {
                     auto const & ctx = t.valueItem().m_context;
                     if (tls.m_currentSection) {
                         throw Configuration::DuplicateKeyException(
-                                concat("Duplicate key \"", std::move(keyStr),
+                                concat("Duplicate key \"", key.str(),
                                        "\" in section [",
                                        currentSectionName,
                                        "]! Previous declaration was in \"",
@@ -477,8 +1163,7 @@ std::string FileParseJob::ParseState::parseFile(TopLevelParseState<Ptree> & tls,
                                        ctx.m_lineNumber, '.'));
                     } else {
                         throw Configuration::DuplicateKeyException(
-                                concat("Duplicate top-level key \"",
-                                       std::move(keyStr),
+                                concat("Duplicate top-level key \"", key.str(),
                                        "\"! Previous declaration was in \"",
                                        ctx.m_filename->string(), "\" on line ",
                                        ctx.m_lineNumber, '.'));
@@ -497,9 +1182,13 @@ std::string FileParseJob::ParseState::parseFile(TopLevelParseState<Ptree> & tls,
                                 lv.substr(sepPos + 1u).trimmed(whitespace)),
                             fpj.m_canonicalPath,
                             m_lineNumber);
-                container.push_back(
-                            std::make_pair(std::move(keyStr),
-                                           Ptree(std::move(treeItem))));
+                auto & container = tls.m_currentSection
+                                   ? *tls.m_currentSection
+                                   : tls.m_result;
+                auto const it(container.push_back(
+                                  std::make_pair(key.str(),
+                                                 Ptree(std::move(treeItem)))));
+                index.tryEmplaceHashed(StringView(it->first), hash, it->second);
             }
         }
     }
@@ -508,9 +1197,27 @@ std::string FileParseJob::ParseState::parseFile(TopLevelParseState<Ptree> & tls,
 
 template <typename Ptree>
 std::string FileParseJob::parseFile(TopLevelParseState<Ptree> & tls) {
+    struct WallTimer {
+        ~WallTimer() noexcept {
+            if (statistics)
+                statistics->wallTime += LoadClock::now() - start;
+        }
+        Configuration::LoadedFileStatistics * const statistics;
+        LoadClock::time_point const start;
+    } const wallTimer{tls.fileStatistics(*this), LoadClock::now()};
     if (!m_state.hasValue()) {
         try {
-            m_state.emplace(*m_canonicalPath);
+            PhaseTimer const timer(tls.m_timings.open);
+            if (m_preloadedContents) {
+                m_state.emplace(std::move(m_preloadedContents),
+                                m_preloadedFileId);
+            } else {
+                m_state.emplace(*m_canonicalPath, tls.m_timings.read);
+            }
+            auto const maxFileSize = tls.m_options.maxFileSize;
+            if ((maxFileSize < std::numeric_limits<std::uint64_t>::max())
+                && (m_state->m_inFile.size() > maxFileSize))
+                throw Configuration::FileTooLargeException();
             auto fileId(m_state->m_inFile.fileId());
             if (tls.m_visitedFiles.find(fileId) != tls.m_visitedFiles.end())
                 throw Configuration::IncludeLoopException();
@@ -522,8 +1229,16 @@ std::string FileParseJob::parseFile(TopLevelParseState<Ptree> & tls) {
                                    m_canonicalPath->string(), "\"!")));
         }
     }
+    auto & timings = tls.m_timings;
+    auto const readTimeBefore = timings.read;
+    auto const parseStart = LoadClock::now();
     try {
-        return m_state->parseFile(tls, *this);
+        auto r(m_state->parseFile(tls, *this));
+        timings.parse +=
+                (LoadClock::now() - parseStart) - (timings.read - readTimeBefore);
+        return r;
+    } catch (Configuration::LoadCancelledException const &) {
+        throw;
     } catch (...) {
         std::throw_with_nested(
                     Configuration::ParseException(
@@ -533,31 +1248,8 @@ std::string FileParseJob::parseFile(TopLevelParseState<Ptree> & tls) {
     }
 }
 
-template <typename T>
-using Translator =
-    typename boost::property_tree::translator_between<std::string, T>::type;
-
-template <typename T> struct ValueHandler {
-    static T parse(std::string value) {
-        try {
-            if (auto const optionalValue = Translator<T>().get_value(value))
-                return *optionalValue;
-            throw Configuration::FailedToParseValueException();
-        } catch (...) {
-            std::throw_with_nested(
-                        Configuration::FailedToParseValueException());
-        }
-    }
-    static T generateDefault(T value) noexcept { return value; }
-};
-
-template <> struct ValueHandler<std::string> {
-    static std::string parse(std::string value) { return value; }
-    static std::string generateDefault(StringView value) { return value.str(); }
-};
-
 template <typename Ptree>
-ValueItem const * findValueItem(Ptree const & ptree) {
+ValueItem const * findValueItem(Ptree const & ptree) noexcept {
     if (auto const & valuePtr = ptree.data()) {
         auto const & treeItem = getTreeItem(valuePtr);
         if (treeItem.hasValueItem())
@@ -573,54 +1265,275 @@ bool hasSectionItem(Ptree const & ptree) {
     return false;
 }
 
+/**
+  \returns the direct child with the given key and its key, if any. Unlike
+           get_child_optional(), this does not construct a ptree path from the
+           key, hence never allocates memory.
+*/
+inline Tree::value_type const * findDirectChildEntry(
+        Tree const & ptree,
+        std::string const & key,
+        WideNodeIndexes const & wideNodes) noexcept
+{
+    if (auto const * const index = wideNodes.find(ptree)) {
+        auto const * const child = index->find(key);
+        return child ? *child : nullptr;
+    }
+    auto const it(ptree.find(key));
+    return (it != ptree.not_found()) ? &*it : nullptr;
+}
+
+/** \returns the direct child with the given key, if any. */
 template <typename Ptree>
-Ptree * findChild(Ptree & ptree, Path const & path) {
+Ptree * findDirectChild(Ptree & ptree,
+                        std::string const & key,
+                        WideNodeIndexes const & wideNodes) noexcept
+{
+    auto const * const child = findDirectChildEntry(ptree, key, wideNodes);
+    return child ? const_cast<Ptree *>(&child->second) : nullptr;
+}
+
+template <typename Ptree>
+Ptree * findChild(Ptree & ptree,
+                  Path const & path,
+                  WideNodeIndexes const & wideNodes) noexcept
+{
     auto r = &ptree;
-    for (auto const & component : path.components()) {
-        if (auto const p = r->get_child_optional(component)) {
-            r = &*p;
-        } else {
+    for (auto const & component : path.components())
+        if (!(r = findDirectChild(*r, component, wideNodes)))
             return nullptr;
-        }
-    }
     return r;
 }
 
 template <typename Ptree>
-ValueItem const * findValueItem(Ptree const & ptree, Path const & path) {
-    if (auto const * child = findChild(ptree, path))
-        return findValueItem(*child);
+inline void countAccess(Ptree const & ptree) noexcept {
+    if (auto const & valuePtr = ptree.data())
+        getTreeItem(valuePtr).countAccess();
+}
+
+/** \brief Like findValueItem(), but counts the access if tracking accesses. */
+template <typename Ptree>
+ValueItem const * findValueItem(Ptree const & ptree,
+                                ReadContext const & context) noexcept
+{
+    if (context.trackAccesses)
+        countAccess(ptree);
+    return findValueItem(ptree);
+}
+
+template <typename Ptree>
+ValueItem const * findValueItem(Ptree const & ptree,
+                                Path const & path,
+                                ReadContext const & context) noexcept
+{
+    if (auto const * child = findChild(ptree, path, *context.wideNodes))
+        return findValueItem(*child, context);
     return nullptr;
 }
 
+/** \brief Like hasSectionItem(), but counts the access if tracking accesses. */
+template <typename Ptree>
+bool hasSectionItem(Ptree const & ptree, ReadContext const & context) {
+    if (context.trackAccesses)
+        countAccess(ptree);
+    return hasSectionItem(ptree);
+}
+
 template <typename Ptree>
-bool hasSectionItem(Ptree const & ptree, Path const & path) {
-    if (auto const * child = findChild(ptree, path))
-        return hasSectionItem(*child);
+bool hasSectionItem(Ptree const & ptree,
+                    Path const & path,
+                    ReadContext const & context)
+{
+    if (auto const * child = findChild(ptree, path, *context.wideNodes))
+        return hasSectionItem(*child, context);
     return false;
 }
 
+/**
+  \returns whether the value was successfully parsed into out.
+  \throws std::bad_alloc
+  \throws Configuration::InterpolationException
+*/
+template <typename T>
+bool tryParseValueItem(ValueItem const & valueItem,
+                       ReadContext const & context,
+                       T & out)
+{
+    if (!valueItem.m_needsInterpolation) {
+        if (context.cacheParsedValues
+            && !std::is_same<T, std::string>::value)
+        {
+            if (auto const * const cached = valueItem.cachedValue<T>()) {
+                out = *cached;
+                return true;
+            }
+            T value;
+            if (!ValueHandler<T>::tryParse(valueItem.m_value, value))
+                return false;
+            out = valueItem.cacheValue(std::move(value));
+            return true;
+        }
+        return ValueHandler<T>::tryParse(valueItem.m_value, out);
+    }
+    if (context.interpolation)
+        return ValueHandler<T>::tryParse(
+                    valueItem.interpolated(*context.interpolation),
+                    out);
+    return ValueHandler<T>::tryParse(valueItem.m_value, out);
+}
+
+template <typename T>
+T parseValueItem(ValueItem const & valueItem, ReadContext const & context) {
+    try {
+        T r;
+        if (tryParseValueItem(valueItem, context, r))
+            return r;
+        throw Configuration::FailedToParseValueException();
+    } catch (Configuration::InterpolationException const &) {
+        throw;
+    } catch (...) {
+        std::throw_with_nested(Configuration::FailedToParseValueException());
+    }
+}
+
+inline StringView viewValueItem(ValueItem const & valueItem,
+                                ReadContext const & context)
+{
+    if (valueItem.m_needsInterpolation && context.interpolation)
+        return valueItem.interpolatedView(*context.interpolation);
+    return valueItem.m_value;
+}
+
+template <typename Ptree>
+StringView readView(Ptree const & ptree, ReadContext const & context) {
+    if (auto const * valueItem = findValueItem(ptree, context))
+        return viewValueItem(*valueItem, context);
+    throw Configuration::ValueNotFoundException();
+}
+
+template <typename Ptree>
+StringView readView(Ptree const & ptree,
+                    Path const & path,
+                    ReadContext const & context)
+{
+    if (auto const * valueItem = findValueItem(ptree, path, context))
+        return viewValueItem(*valueItem, context);
+    throw Configuration::ValueNotFoundException();
+}
+
+template <typename Ptree>
+StringView readView(Ptree const & ptree,
+                    Path const & path,
+                    ReadContext const & context,
+                    StringView defaultValue)
+{
+    if (auto const * valueItem = findValueItem(ptree, path, context))
+        return viewValueItem(*valueItem, context);
+    return defaultValue;
+}
+
+template <typename T>
+Configuration::GetResult<T> tryReadValueItem(ValueItem const * valueItem,
+                                             ReadContext const & context)
+        noexcept
+{
+    using GetError = Configuration::GetError;
+    if (!valueItem)
+        return GetError::ValueNotFound;
+    try {
+        T r;
+        if (tryParseValueItem(*valueItem, context, r))
+            return Configuration::GetResult<T>(std::move(r));
+        return GetError::ParseFailed;
+    } catch (Configuration::InterpolationException const &) {
+        return GetError::InterpolationFailed;
+    } catch (std::bad_alloc const &) {
+        return GetError::OutOfMemory;
+    } catch (...) {
+        return GetError::ParseFailed;
+    }
+}
+
+template <typename T, typename Ptree>
+T readValue(Ptree const & ptree, ReadContext const & context) {
+    if (auto const * valueItem = findValueItem(ptree, context))
+        return parseValueItem<T>(*valueItem, context);
+    throw Configuration::ValueNotFoundException();
+}
+
+template <typename T, typename Ptree>
+T readValue(Ptree const & ptree,
+            Path const & path,
+            ReadContext const & context)
+{
+    if (auto const * valueItem = findValueItem(ptree, path, context))
+        return parseValueItem<T>(*valueItem, context);
+    throw Configuration::ValueNotFoundException();
+}
+
+template <typename T, typename Ptree, typename Default>
+T readValue(Ptree const & ptree,
+            Path const & path,
+            ReadContext const & context,
+            Default && defaultValue)
+{
+    if (auto const * valueItem = findValueItem(ptree, path, context))
+        return parseValueItem<T>(*valueItem, context);
+    return ValueHandler<T>::generateDefault(
+                std::forward<Default>(defaultValue));
+}
+
+/**
+  \brief Calls f(treeItem, path) for every node with data in the given subtree,
+         in pre-order, with path relative to the root of the subtree.
+*/
+template <typename Ptree, typename F>
+void forEachTreeItem(Ptree const & node, Path & path, F & f) {
+    if (auto const & valuePtr = node.data())
+        f(getTreeItem(valuePtr), static_cast<Path const &>(path));
+    for (auto const & child : node) {
+        path.components().emplace_back(child.first);
+        forEachTreeItem(child.second, path, f);
+        path.components().pop_back();
+    }
+}
+
 template <typename Ptree>
-inline bool valueEraser(TreeItem & t, Ptree &) noexcept {
+void resetSubtreeAccessCounts(Ptree const & node) noexcept {
+    if (auto const & valuePtr = node.data())
+        getTreeItem(valuePtr).resetAccessCount();
+    for (auto const & child : node)
+        resetSubtreeAccessCounts(child.second);
+}
+
+inline Path joinPaths(Path const * const prefix, Path const & path)
+{ return prefix ? *prefix + path : path; }
+
+template <typename Inner, typename Ptree>
+inline bool valueEraser(Inner &, TreeItem & t, Ptree &) noexcept {
     if (!t.hasSectionItem())
         return true;
     t.eraseValueItem();
     return false;
 }
 
-template <typename Ptree>
-inline bool sectionEraser(TreeItem & t, Ptree & element) noexcept {
+template <typename Inner, typename Ptree>
+inline bool sectionEraser(Inner & inner, TreeItem & t, Ptree & element)
+        noexcept
+{
     if (!t.hasValueItem())
         return true;
     t.eraseSectionItem();
-    element.erase(element.begin(), element.end());
+    inner.eraseChildren(element);
     return false;
 }
 
-template <typename Ptree>
-void erasePart(Ptree & root,
+template <typename Inner, typename Ptree>
+void erasePart(Inner & inner,
+               Ptree & root,
                Path const & path,
-               bool (*eraseReturnWhetherNeedFullErasure)(TreeItem &,
+               bool (*eraseReturnWhetherNeedFullErasure)(Inner &,
+                                                         TreeItem &,
                                                          Ptree &) noexcept)
         noexcept
 {
@@ -628,8 +1541,10 @@ void erasePart(Ptree & root,
     auto it(std::begin(path.components()));
     if (it == end) {
         if (auto const & valuePtr = root.data())
-            if (eraseReturnWhetherNeedFullErasure(getTreeItem(valuePtr), root))
-                root.clear();
+            if (eraseReturnWhetherNeedFullErasure(inner,
+                                                  getTreeItem(valuePtr),
+                                                  root))
+                inner.clearNode(root);
         return;
     }
 
@@ -643,32 +1558,92 @@ void erasePart(Ptree & root,
     }
     if (auto const child = parent->get_child_optional(*it)) {
         if (auto const & valuePtr = child->data())
-            if (!eraseReturnWhetherNeedFullErasure(getTreeItem(valuePtr),
+            if (!eraseReturnWhetherNeedFullErasure(inner,
+                                                   getTreeItem(valuePtr),
                                                    *child))
                 return;
-        parent->erase(*it);
+        inner.eraseChild(*parent, *it);
     }
 }
 
+/**
+  \brief Matches the given string against the given wildcard pattern, in which
+         '*' matches any sequence of characters and '?' any single character.
+*/
+inline bool wildcardMatch(StringView const pattern, StringView const str)
+        noexcept
+{
+    std::size_t p = 0u;
+    std::size_t s = 0u;
+    std::size_t starP = StringView::npos;
+    std::size_t starS = 0u;
+    while (s < str.size()) {
+        if ((p < pattern.size()) && (pattern[p] == '*')) {
+            starP = p++;
+            starS = s;
+        } else if ((p < pattern.size())
+                   && ((pattern[p] == '?') || (pattern[p] == str[s])))
+        {
+            ++p;
+            ++s;
+        } else if (starP != StringView::npos) {
+            // Backtrack, letting the last '*' consume one more character:
+            p = starP + 1u;
+            s = ++starS;
+        } else {
+            return false;
+        }
+    }
+    while ((p < pattern.size()) && (pattern[p] == '*'))
+        ++p;
+    return p == pattern.size();
+}
+
+inline bool keyLess(std::string const & key, StringView const str) noexcept
+{ return key.compare(0u, key.size(), str.data(), str.size()) < 0; }
+
+inline bool keyHasPrefix(std::string const & key, StringView const prefix)
+        noexcept
+{
+    return (key.size() >= prefix.size())
+           && (key.compare(0u, prefix.size(), prefix.data(), prefix.size())
+               == 0);
+}
+
 } // anonymous namespace
 
-struct SHAREMIND_VISIBILITY_INTERNAL Configuration::Inner {
+struct SHAREMIND_VISIBILITY_INTERNAL Configuration::Inner
+        : std::enable_shared_from_this<Inner>
+{
+
+/* Types: */
+
+    struct ChildIndex {
+        std::vector<ptree::value_type const *> m_sorted;
+    };
+
+    static_assert(std::is_same<ptree, Tree>::value, "");
 
 /* Methods: */
 
     Inner(std::vector<std::string> const & tryPaths,
-          std::shared_ptr<Interpolation> interpolation)
+          std::shared_ptr<Interpolation> interpolation,
+          LoadOptions const & options)
         : m_interpolation(std::move(interpolation))
     {
         if (tryPaths.empty())
             throw NoTryPathsGivenException();
+        auto const loadStart = LoadClock::now();
         for (auto const & path : tryPaths) {
             boost::filesystem::path boostPath(path);
             if (!boost::filesystem::exists(boostPath))
                 continue;
             try {
-                initFromPath(path, std::move(boostPath));
+                initFromPath(path, std::move(boostPath), options);
+                m_loadTimings.total = LoadClock::now() - loadStart;
                 return;
+            } catch (LoadCancelledException const &) {
+                throw;
             } catch (std::exception const & e) {
                 std::throw_with_nested(
                             FailedToOpenAndParseConfigurationException(
@@ -706,11 +1681,15 @@ struct SHAREMIND_VISIBILITY_INTERNAL Configuration::Inner {
     }
 
     Inner(StringView filename,
-          std::shared_ptr<Interpolation> interpolation)
+          std::shared_ptr<Interpolation> interpolation,
+          LoadOptions const & options)
         : m_interpolation(std::move(interpolation))
     {
+        auto const loadStart = LoadClock::now();
         try {
-            initFromPath(filename.str());
+            initFromPath(filename.str(), options);
+        } catch (LoadCancelledException const &) {
+            throw;
         } catch (...) {
             std::throw_with_nested(
                         FailedToOpenAndParseConfigurationException(
@@ -718,74 +1697,413 @@ struct SHAREMIND_VISIBILITY_INTERNAL Configuration::Inner {
                                    "configuration from file \"", filename,
                                    "\"!")));
         }
+        m_loadTimings.total = LoadClock::now() - loadStart;
     }
 
     Inner(Inner &&) = delete;
-    Inner(Inner const &) = default;
+
+    Inner(Inner const & copy)
+        : std::enable_shared_from_this<Inner>()
+        , m_interpolation(copy.m_interpolation)
+        , m_cacheParsedValues(
+                copy.m_cacheParsedValues.load(std::memory_order_relaxed))
+        , m_trackAccesses(copy.m_trackAccesses.load(std::memory_order_relaxed))
+        , m_filename(copy.m_filename)
+        , m_loadTimings(copy.m_loadTimings)
+        , m_loadStatistics(copy.m_loadStatistics)
+        , m_ptree(copy.m_ptree)
+    { indexWideNodes(m_ptree); }
 
     Inner & operator=(Inner &&) = delete;
     Inner & operator=(Inner const &) = delete;
 
-    void initFromPath(std::string path) {
+    void initFromPath(std::string path, LoadOptions const & options) {
         boost::filesystem::path const boostPath(path);
-        initFromPath(std::move(path), boostPath);
+        initFromPath(std::move(path), boostPath, options);
     }
 
     void initFromPath(std::string path,
-                      boost::filesystem::path const & boostPath)
+                      boost::filesystem::path const & boostPath,
+                      LoadOptions const & options)
     {
-        TopLevelParseState<decltype(m_ptree)> parser(m_ptree);
-        parser.pushJob(boostPath);
+        TopLevelParseState<decltype(m_ptree)> parser(m_ptree,
+                                                     options,
+                                                     m_loadTimings,
+                                                     m_loadStatistics);
+        FilePrefetcher prefetcher;
+        std::unique_ptr<IoUringFileLoader> ioUringLoader;
+        bool ioUringUnavailable = !options.useIoUring;
+        auto const preload =
+                [&](std::vector<PendingInclude> & includes) {
+                    if (ioUringUnavailable || (includes.size() < 2u))
+                        return false;
+                    std::vector<char const *> paths;
+                    paths.reserve(includes.size());
+                    for (auto const & include : includes)
+                        paths.emplace_back(include.path.c_str());
+                    PhaseTimer const timer(m_loadTimings.read);
+                    if (!ioUringLoader) {
+                        try {
+                            ioUringLoader =
+                                    std::make_unique<IoUringFileLoader>();
+                        } catch (std::system_error const &) {
+                            // Fall back to reading the files one by one:
+                            ioUringUnavailable = true;
+                            return false;
+                        }
+                    }
+                    /* No fallback once operations have been submitted, since
+                       these might still be in flight after a failure: */
+                    auto files(ioUringLoader->load(paths,
+                                                   options.maxFileSize));
+                    for (std::size_t i = 0u; i < files.size(); ++i) {
+                        auto & file = files[i];
+                        if (!file.loaded)
+                            continue;
+                        auto & include = includes[i];
+                        include.contents = std::make_shared<std::string const>(
+                                               std::move(file.contents));
+                        include.fileId.deviceId = file.deviceId;
+                        include.fileId.inode = file.inode;
+                    }
+                    return true;
+                };
+        parser.checkCancelled();
+        {
+            PendingInclude root;
+            root.path = boostPath.string();
+            parser.pushInclude(std::move(root));
+        }
 
-        for (;;) {
-            assert(parser.m_fileParseJob);
-            auto & fps = *parser.m_fileParseJob;
+        std::vector<PendingInclude> includes;
+        std::size_t includedFiles = 0u;
+        do {
+            parser.checkCancelled();
+            auto & fps = parser.topJob();
             auto globStr(fps.parseFile(parser));
             if (globStr.empty()) {
                 parser.popJob();
-                if (!parser.m_fileParseJob)
-                    break;
-            } else {
-                if (globStr.front() != '/') {
-                    globStr = fps.getEscapedCurrentFileDirectory() + '/'
-                              + globStr;
-                    assert(globStr.front() == '/');
-                }
-                ::glob_t globResults;
-                auto const r =
-                        ::glob(globStr.c_str(),
-                               GLOB_ERR | GLOB_NOCHECK | GLOB_NOSORT,
-                               nullptr,
-                               &globResults);
-                if (r != 0) {
-                    if (r == GLOB_NOSPACE)
-                        throw std::bad_alloc();
-                    throw GlobException();
-                }
+                continue;
+            }
+            if (globStr.front() != '/') {
+                globStr = fps.getEscapedCurrentFileDirectory() + '/' + globStr;
+                assert(globStr.front() == '/');
+            }
+            if (options.collectStatistics)
+                ++m_loadStatistics.includeDirectives;
+            auto const includeDepth = fps.m_includeDepth + 1u;
+            includes.clear();
+            {
+                PhaseTimer const timer(m_loadTimings.glob);
+                if (!listDirectoryIncludes(globStr, includes))
+                    globIncludes(globStr, includes);
+            }
+            if (includes.size() > options.maxIncludedFiles - includedFiles) {
                 try {
-                    // We do our own LC_COLLATE-unaware sorting of glob paths:
-                    std::set<std::string> includes;
-                    for (auto i = globResults.gl_pathc; i > 0u; --i)
-                        includes.emplace(globResults.gl_pathv[i - 1u]);
-                    for (auto include : reverseRange(includes))
-                        parser.pushJob(std::move(include));
+                    throw TooManyIncludedFilesException();
                 } catch (...) {
-                    ::globfree(&globResults);
-                    throw;
+                    std::throw_with_nested(
+                            ParseException(
+                                concat("Failed to parse file \"",
+                                       fps.m_canonicalPath->string(),
+                                       "\" (line ", fps.m_state->m_lineNumber,
+                                       ")!")));
                 }
-                ::globfree(&globResults);
             }
+            includedFiles += includes.size();
+            if (!preload(includes) && options.prefetchIncludes) {
+                std::vector<std::string> paths;
+                paths.reserve(includes.size());
+                for (auto const & include : includes)
+                    paths.emplace_back(include.path);
+                prefetcher.prefetch(std::move(paths));
+            }
+            for (auto & include : reverseRange(includes)) {
+                include.includeDepth = includeDepth;
+                parser.pushInclude(std::move(include));
+            }
+        } while (!parser.empty());
+
+        if (options.collectStatistics) {
+            auto & s = m_loadStatistics;
+            for (auto const & file : s.files) {
+                s.bytes += file.bytes;
+                s.lines += file.lines;
+                s.keys += file.keys;
+                s.sections += file.sections;
+                s.maxIncludeDepth = std::max(s.maxIncludeDepth,
+                                             file.includeDepth);
+            }
+        }
+
+        {
+            PhaseTimer const timer(m_loadTimings.index);
+            indexWideNodes(m_ptree);
         }
+        m_filename = std::move(path);
+    }
+
+    /**
+      \returns a shared pointer to this object for non-owning handles to create
+               Configuration objects from.
+      \pre This object is owned by a std::shared_ptr.
+    */
+    std::shared_ptr<Inner> sharedFromThis() const
+    { return std::const_pointer_cast<Inner>(shared_from_this()); }
+
+    ReadContext readContext() const noexcept {
+        return ReadContext{m_interpolation.get(),
+                           m_cacheParsedValues.load(std::memory_order_relaxed),
+                           m_trackAccesses.load(std::memory_order_relaxed),
+                           &m_wideNodes};
+    }
+
+    /**
+      \returns the sorted index of the children of the given node, which is
+               built on first use, or null if the node has no children.
+    */
+    ChildIndex const * childIndex(ptree const & node) const {
+        if (node.empty())
+            return nullptr;
+        std::lock_guard<std::mutex> const guard(m_childIndexesMutex);
+        auto const r(m_childIndexes.emplace(&node, ChildIndex()));
+        if (r.second) {
+            auto & sorted = r.first->second.m_sorted;
+            try {
+                sorted.reserve(node.size());
+            } catch (...) {
+                m_childIndexes.erase(r.first);
+                throw;
+            }
+            for (auto const & child : node)
+                sorted.emplace_back(&child);
+            std::stable_sort(sorted.begin(),
+                             sorted.end(),
+                             [](ptree::value_type const * const lhs,
+                                ptree::value_type const * const rhs) noexcept
+                             { return lhs->first < rhs->first; });
+        }
+        return &r.first->second;
+    }
+
+    /**
+      \returns the sorted index of the children of the given node if it has
+               already been built, otherwise null.
+    */
+    ChildIndex const * builtChildIndex(ptree const & node) const noexcept {
+        std::lock_guard<std::mutex> const guard(m_childIndexesMutex);
+        auto const it(m_childIndexes.find(&node));
+        return (it != m_childIndexes.end()) ? &it->second : nullptr;
+    }
+
+    MemoryUsage memoryUsage(ptree const & node) const {
+        MemoryUsage r;
+        std::unordered_set<boost::filesystem::path const *> contexts;
+        addMemoryUsage(node, r, contexts);
+        if (&node == &m_ptree) {
+            std::lock_guard<std::mutex> const guard(m_childIndexesMutex);
+            r.structure += m_childIndexes.bucket_count() * sizeof(void *)
+                           + m_wideNodes.bucketMemoryUsage();
+        }
+        if (m_interpolation)
+            r.interpolation = m_interpolation->memoryUsage();
+        return r;
+    }
+
+    void addMemoryUsage(
+            ptree const & node,
+            MemoryUsage & r,
+            std::unordered_set<boost::filesystem::path const *> & contexts)
+            const
+    {
+        /* Every ptree allocates a multi-index container with a header node,
+           and every node in it carries links for the sequenced and ordered
+           indexes: */
+        constexpr std::size_t const nodeSize =
+                sizeof(ptree::value_type) + 5u * sizeof(void *);
+        r.structure += nodeSize;
+        r.structure += node.size() * nodeSize;
+
+        if (auto const & valuePtr = node.data()) {
+            r.structure += sizeof(TreeItem) + sharedControlBlockSize;
+            auto const & treeItem = getTreeItem(valuePtr);
+            if (treeItem.hasValueItem()) {
+                auto const & valueItem = treeItem.valueItem();
+                r.values += valueItem.memoryUsage();
+                auto const * const filename =
+                        valueItem.m_context.m_filename.get();
+                if (filename && contexts.insert(filename).second)
+                    r.contexts += sizeof(*filename) + sharedControlBlockSize
+                                  + heapUsage(filename->native());
+            }
+        }
+
+        if (auto const * const index = builtChildIndex(node))
+            r.structure +=
+                    sizeof(std::pair<ptree const * const, ChildIndex>)
+                    + 2u * sizeof(void *)
+                    + index->m_sorted.capacity()
+                      * sizeof(ptree::value_type const *);
+        r.structure += m_wideNodes.memoryUsage(node);
+
+        for (auto const & child : node) {
+            r.keys += heapUsage(child.first);
+            addMemoryUsage(child.second, r, contexts);
+        }
+    }
+
+    /**
+      \brief Recursively matches the given node against the pattern starting at
+             the given component, calling emit(node, keys) for every match.
+    */
+    template <typename Emit>
+    void matchPattern(ptree const & node,
+                      Path::Components const & pattern,
+                      Path::SizeType const i,
+                      std::vector<std::string const *> & keys,
+                      std::unordered_set<ptree const *> & emitted,
+                      Emit & emit) const
+    {
+        if (i == pattern.size()) {
+            if (!keys.empty() && emitted.emplace(&node).second)
+                emit(node, keys);
+            return;
+        }
+
+        auto const & component = pattern[i];
+        auto const recurse =
+                [&](ptree::value_type const & child, Path::SizeType const next)
+                {
+                    keys.emplace_back(&child.first);
+                    matchPattern(child.second,
+                                 pattern,
+                                 next,
+                                 keys,
+                                 emitted,
+                                 emit);
+                    keys.pop_back();
+                };
+
+        if (component == "**") {
+            matchPattern(node, pattern, i + 1u, keys, emitted, emit);
+            for (auto const & child : node)
+                recurse(child, i);
+            return;
+        }
+
+        auto const wildcardPos = component.find_first_of("*?");
+        if (wildcardPos == std::string::npos) {
+            auto const range(node.equal_range(component));
+            for (auto it = range.first; it != range.second; ++it)
+                recurse(*it, i + 1u);
+            return;
+        }
+
+        /* Only components with a literal prefix benefit from the sorted index,
+           hence others do not build it: */
+        if (wildcardPos == 0u) {
+            for (auto const & child : node)
+                if (wildcardMatch(component, child.first))
+                    recurse(child, i + 1u);
+            return;
+        }
+
+        auto const * const index = childIndex(node);
+        if (!index)
+            return;
+        auto const & sorted = index->m_sorted;
+        StringView const literalPrefix(component.data(), wildcardPos);
+        auto it(std::lower_bound(sorted.begin(),
+                                 sorted.end(),
+                                 literalPrefix,
+                                 [](ptree::value_type const * const v,
+                                    StringView const str) noexcept
+                                 { return keyLess(v->first, str); }));
+        for (; (it != sorted.end())
+               && keyHasPrefix((*it)->first, literalPrefix);
+             ++it)
+            if (wildcardMatch(component, (*it)->first))
+                recurse(**it, i + 1u);
+    }
+
+    void indexWideNodes(ptree const & node) {
+        if (node.empty())
+            return;
+        for (auto const & child : node)
+            indexWideNodes(child.second);
+        m_wideNodes.index(node);
+    }
 
-        m_filename = std::move(path);
+    void unindexSubtree(ptree const & node) noexcept {
+        if (node.empty())
+            return;
+        m_childIndexes.erase(&node);
+        m_wideNodes.unindex(node);
+        for (auto const & child : node)
+            unindexSubtree(child.second);
+    }
+
+    void clearNode(ptree & node) noexcept {
+        unindexSubtree(node);
+        node.clear();
+    }
+
+    void eraseChildren(ptree & node) noexcept {
+        unindexSubtree(node);
+        node.erase(node.begin(), node.end());
+    }
+
+    void eraseChild(ptree & parent, std::string const & key) noexcept {
+        auto const range(parent.equal_range(key));
+        if (range.first == range.second)
+            return;
+        for (auto it = range.first; it != range.second; ++it)
+            unindexSubtree(it->second);
+        auto const indexIt(m_childIndexes.find(&parent));
+        if (indexIt != m_childIndexes.end()) {
+            auto & sorted = indexIt->second.m_sorted;
+            auto const first(
+                    std::lower_bound(sorted.begin(),
+                                     sorted.end(),
+                                     key,
+                                     [](ptree::value_type const * const v,
+                                        std::string const & k) noexcept
+                                     { return v->first < k; }));
+            auto const last(
+                    std::upper_bound(first,
+                                     sorted.end(),
+                                     key,
+                                     [](std::string const & k,
+                                        ptree::value_type const * const v)
+                                            noexcept
+                                     { return k < v->first; }));
+            sorted.erase(first, last);
+            if (sorted.empty())
+                m_childIndexes.erase(indexIt);
+        }
+        m_wideNodes.eraseKey(parent, key);
+        parent.erase(key);
+        if (!WideNodeIndexes::isWide(parent))
+            m_wideNodes.unindex(parent);
     }
 
 /* Fields: */
 
     std::shared_ptr<Interpolation> m_interpolation;
+    /* Flags which may be toggled while other threads read values: */
+    std::atomic<bool> m_cacheParsedValues{false};
+    std::atomic<bool> m_trackAccesses{false};
     std::string m_filename;
+    LoadTimings m_loadTimings;
+    LoadStatistics m_loadStatistics;
     ptree m_ptree;
 
+    /* Sorted indexes of the children of nodes, built on first use: */
+    mutable std::unordered_map<ptree const *, ChildIndex> m_childIndexes;
+    mutable std::mutex m_childIndexesMutex;
+
+    WideNodeIndexes m_wideNodes;
+
 };
 
 #define SHAREMIND_LIBCONFIGURATION_CONFIGURATION_IF_DEFINE(C,c,...) \
@@ -826,6 +2144,112 @@ SHAREMIND_LIBCONFIGURATION_CONFIGURATION_IF_DEFINE(Const,const,
     const_cast<ptree &>(value.second))
 #undef SHAREMIND_LIBCONFIGURATION_CONFIGURATION_IF_DEFINE
 
+Path Configuration::Child::path() const {
+    if (m_parentPath)
+        return *m_parentPath + *m_key;
+    return Path(*m_key);
+}
+
+Configuration Configuration::Child::configuration() const {
+    return Configuration(std::make_shared<Path>(path()),
+                         m_inner->sharedFromThis(),
+                         const_cast<ptree &>(*m_node));
+}
+
+std::string const & Configuration::View::key() const noexcept {
+    static std::string const emptyKey;
+    return m_key ? *m_key : emptyKey;
+}
+
+bool Configuration::View::empty() const noexcept { return m_node->empty(); }
+
+Configuration::SizeType Configuration::View::size() const noexcept
+{ return m_node->size(); }
+
+Configuration::View::Iterator Configuration::View::begin() const noexcept
+{ return Iterator(m_node->begin(), ViewTransformer(*m_inner)); }
+
+Configuration::View::Iterator Configuration::View::end() const noexcept
+{ return Iterator(m_node->end(), ViewTransformer(*m_inner)); }
+
+bool Configuration::View::hasValue() const
+{ return findValueItem(*m_node, m_inner->readContext()); }
+
+bool Configuration::View::hasValue(Path const & path) const
+{ return findValueItem(*m_node, path, m_inner->readContext()); }
+
+bool Configuration::View::hasSection() const
+{ return hasSectionItem(*m_node, m_inner->readContext()); }
+
+bool Configuration::View::hasSection(Path const & path) const
+{ return hasSectionItem(*m_node, path, m_inner->readContext()); }
+
+template <typename T>
+auto Configuration::View::value() const
+        -> typename std::enable_if<isReadableValueType<T>, T>::type
+{ return readValue<T>(*m_node, m_inner->readContext()); }
+
+template <typename T>
+auto Configuration::View::get(Path const & path_) const
+        -> typename std::enable_if<isReadableValueType<T>, T>::type
+{ return readValue<T>(*m_node, path_, m_inner->readContext()); }
+
+template <typename T>
+auto Configuration::View::get(Path const & path_,
+                              DefaultValueType<T> defaultValue) const
+        -> typename std::enable_if<isReadableValueType<T>, T>::type
+{
+    return readValue<T>(*m_node,
+                        path_,
+                        m_inner->readContext(),
+                        std::move(defaultValue));
+}
+
+template <typename T>
+auto Configuration::View::tryValue() const noexcept
+        -> typename std::enable_if<isReadableValueType<T>,
+                                   GetResult<T> >::type
+{
+    auto const context(m_inner->readContext());
+    return tryReadValueItem<T>(findValueItem(*m_node, context), context);
+}
+
+template <typename T>
+auto Configuration::View::tryGet(Path const & path_) const noexcept
+        -> typename std::enable_if<isReadableValueType<T>,
+                                   GetResult<T> >::type
+{
+    auto const context(m_inner->readContext());
+    return tryReadValueItem<T>(findValueItem(*m_node, path_, context),
+                               context);
+}
+
+StringView Configuration::View::valueView() const
+{ return readView(*m_node, m_inner->readContext()); }
+
+StringView Configuration::View::getView(Path const & path_) const
+{ return readView(*m_node, path_, m_inner->readContext()); }
+
+StringView Configuration::View::getView(Path const & path_,
+                                        StringView defaultValue) const
+{ return readView(*m_node, path_, m_inner->readContext(), defaultValue); }
+
+Configuration::View Configuration::View::section(Path const & path) const {
+    auto const * node = m_node;
+    auto const * key = m_key;
+    for (auto const & component : path.components()) {
+        auto const * const child =
+                findDirectChildEntry(*node, component, m_inner->m_wideNodes);
+        if (!child)
+            throw SectionNotFoundException();
+        node = &child->second;
+        key = &child->first;
+    }
+    if (!hasSectionItem(*node, m_inner->readContext()))
+        throw SectionNotFoundException();
+    return View(*m_inner, *node, key);
+}
+
 SHAREMIND_DEFINE_EXCEPTION_NOINLINE(sharemind::Exception,
                                     Configuration::,
                                     Exception);
@@ -868,6 +2292,11 @@ SHAREMIND_DEFINE_EXCEPTION_CONST_MSG_NOINLINE(
         Configuration::,
         FailedToParseValueException,
         "Failed to parse value in configuration");
+SHAREMIND_DEFINE_EXCEPTION_CONST_MSG_NOINLINE(
+        Exception,
+        Configuration::,
+        InvalidValueException,
+        "Configuration value failed validation!");
 SHAREMIND_DEFINE_EXCEPTION_CONST_MSG_NOINLINE(
         Exception,
         Configuration::,
@@ -908,6 +2337,153 @@ SHAREMIND_DEFINE_EXCEPTION_CONST_MSG_NOINLINE(
         Configuration::,
         IncludeDirectiveMissingArgumentException,
         "Missing argument to @include directive!");
+SHAREMIND_DEFINE_EXCEPTION_CONST_MSG_NOINLINE(
+        Exception,
+        Configuration::,
+        LoadCancelledException,
+        "Loading the configuration was cancelled!");
+SHAREMIND_DEFINE_EXCEPTION_NOINLINE(Exception,
+                                    Configuration::,
+                                    LoadLimitException);
+SHAREMIND_DEFINE_EXCEPTION_CONST_MSG_NOINLINE(
+        LoadLimitException,
+        Configuration::,
+        LineTooLongException,
+        "Line exceeds the maximum length!");
+SHAREMIND_DEFINE_EXCEPTION_CONST_MSG_NOINLINE(
+        LoadLimitException,
+        Configuration::,
+        FileTooLargeException,
+        "File exceeds the maximum size!");
+SHAREMIND_DEFINE_EXCEPTION_CONST_MSG_NOINLINE(
+        LoadLimitException,
+        Configuration::,
+        IncludeTooDeepException,
+        "@include directives are nested too deeply!");
+SHAREMIND_DEFINE_EXCEPTION_CONST_MSG_NOINLINE(
+        LoadLimitException,
+        Configuration::,
+        TooManyIncludedFilesException,
+        "Too many files included!");
+
+struct Configuration::GetManyException::Data {
+
+    Data(std::vector<Failure> failures)
+        : m_failures(std::move(failures))
+    {
+        assert(!m_failures.empty());
+        m_message = concat("Failed to get ", m_failures.size(),
+                           " configuration value(s):");
+        bool first = true;
+        for (auto const & failure : m_failures) {
+            if (first) {
+                first = false;
+                m_message.append(" \"");
+            } else {
+                m_message.append(", \"");
+            }
+            m_message.append(failure.path.toString()).append("\"");
+            try {
+                std::rethrow_exception(failure.exception);
+            } catch (std::exception const & e) {
+                m_message.append(" (").append(e.what()).append(")");
+            } catch (...) {}
+        }
+    }
+
+    std::vector<Failure> const m_failures;
+    std::string m_message;
+
+};
+
+Configuration::GetManyException::GetManyException(
+        std::vector<Failure> failures)
+    : m_data(std::make_shared<Data>(std::move(failures)))
+{}
+
+Configuration::GetManyException::GetManyException(GetManyException &&)
+        noexcept = default;
+
+Configuration::GetManyException::GetManyException(GetManyException const &)
+        noexcept = default;
+
+Configuration::GetManyException::~GetManyException() noexcept {}
+
+Configuration::GetManyException &
+Configuration::GetManyException::operator=(GetManyException &&) noexcept
+        = default;
+
+Configuration::GetManyException &
+Configuration::GetManyException::operator=(GetManyException const &) noexcept
+        = default;
+
+char const * Configuration::GetManyException::what() const noexcept
+{ return m_data->m_message.c_str(); }
+
+std::vector<Configuration::GetManyException::Failure> const &
+Configuration::GetManyException::failures() const noexcept
+{ return m_data->m_failures; }
+
+struct Configuration::ValidationException::Data {
+
+    Data(std::vector<Failure> failures)
+        : m_failures(std::move(failures))
+    {
+        assert(!m_failures.empty());
+        m_message = concat("Found ", m_failures.size(),
+                           " invalid configuration value(s):");
+        bool first = true;
+        for (auto const & failure : m_failures) {
+            if (first) {
+                first = false;
+                m_message.append(" \"");
+            } else {
+                m_message.append(", \"");
+            }
+            m_message.append(failure.path.toString()).append("\"");
+            if (!failure.filename.empty())
+                m_message.append(concat(" in \"", failure.filename,
+                                        "\" line ", failure.lineNumber));
+            try {
+                std::rethrow_exception(failure.exception);
+            } catch (std::exception const & e) {
+                m_message.append(" (").append(e.what()).append(")");
+            } catch (...) {}
+        }
+    }
+
+    std::vector<Failure> const m_failures;
+    std::string m_message;
+
+};
+
+Configuration::ValidationException::ValidationException(
+        std::vector<Failure> failures)
+    : m_data(std::make_shared<Data>(std::move(failures)))
+{}
+
+Configuration::ValidationException::ValidationException(
+        ValidationException &&) noexcept = default;
+
+Configuration::ValidationException::ValidationException(
+        ValidationException const &) noexcept = default;
+
+Configuration::ValidationException::~ValidationException() noexcept {}
+
+Configuration::ValidationException &
+Configuration::ValidationException::operator=(ValidationException &&) noexcept
+        = default;
+
+Configuration::ValidationException &
+Configuration::ValidationException::operator=(ValidationException const &)
+        noexcept = default;
+
+char const * Configuration::ValidationException::what() const noexcept
+{ return m_data->m_message.c_str(); }
+
+std::vector<Configuration::ValidationException::Failure> const &
+Configuration::ValidationException::failures() const noexcept
+{ return m_data->m_failures; }
 
 SHAREMIND_DEFINE_EXCEPTION_NOINLINE(sharemind::Exception,
                                     Configuration::Interpolation::,
@@ -992,13 +2568,12 @@ std::string Configuration::Interpolation::interpolate(StringView s,
                     s.findFirstOf("{%}"_sv, escapeStartPos + 2u);
             if ((escapeEndPos == StringView::npos) || (s[escapeEndPos] != '}'))
                 throw InterpolationSyntaxErrorException();
-            auto const matchIt(
-                        m_map.find(
-                            s.substr(escapeStartPos,
-                                     escapeEndPos - escapeStartPos).str()));
-            if (matchIt == m_map.cend())
+            auto const * const match =
+                    m_map.find(s.substr(escapeStartPos,
+                                        escapeEndPos - escapeStartPos));
+            if (!match)
                 throw UnknownVariableException();
-            r.append(s.data(), escapePos).append(matchIt->second);
+            r.append(s.data(), escapePos).append(*match);
             s.removePrefix(escapeEndPos + 1u);
             escapePos = 0u;
             break;
@@ -1012,7 +2587,12 @@ std::string Configuration::Interpolation::interpolate(StringView s,
 
 void Configuration::Interpolation::addVariable(std::string var,
                                                std::string value)
-{ m_map.emplace(std::move(var), std::move(value)); }
+{ m_map.tryEmplace(std::move(var), std::move(value)); }
+
+void Configuration::Interpolation::addVariable(std::string var,
+                                               std::size_t const varHash,
+                                               std::string value)
+{ m_map.tryEmplaceHashed(std::move(var), varHash, std::move(value)); }
 
 void Configuration::Interpolation::resetTime()
 { return resetTime(getLocalTimeTm()); }
@@ -1034,6 +2614,13 @@ void Configuration::Interpolation::resetTime(::tm const & theTime)
     return theTimeTm;
 }
 
+std::size_t Configuration::Interpolation::memoryUsage() const noexcept {
+    auto r = m_map.allocatedBytes();
+    for (auto const & entry : m_map)
+        r += heapUsage(entry.key) + heapUsage(entry.value);
+    return r;
+}
+
 Configuration::Configuration(Configuration && move) noexcept = default;
 
 Configuration::Configuration(Configuration const & copy)
@@ -1052,16 +2639,96 @@ Configuration::Configuration(std::vector<std::string> const & tryPaths)
 
 Configuration::Configuration(StringView filename,
                              std::shared_ptr<Interpolation> interpolation)
-    : m_inner(std::make_shared<Inner>(filename, std::move(interpolation)))
-    , m_ptree(&m_inner->m_ptree)
+    : Configuration(filename, std::move(interpolation), LoadOptions())
 {}
 
 Configuration::Configuration(std::vector<std::string> const & tryPaths,
                              std::shared_ptr<Interpolation> interpolation)
-    : m_inner(std::make_shared<Inner>(tryPaths, std::move(interpolation)))
+    : Configuration(tryPaths, std::move(interpolation), LoadOptions())
+{}
+
+Configuration::Configuration(StringView filename,
+                             std::shared_ptr<Interpolation> interpolation,
+                             LoadOptions const & options)
+    : m_inner(std::make_shared<Inner>(filename,
+                                      std::move(interpolation),
+                                      options))
+    , m_ptree(&m_inner->m_ptree)
+{}
+
+Configuration::Configuration(std::vector<std::string> const & tryPaths,
+                             std::shared_ptr<Interpolation> interpolation,
+                             LoadOptions const & options)
+    : m_inner(std::make_shared<Inner>(tryPaths,
+                                      std::move(interpolation),
+                                      options))
     , m_ptree(&m_inner->m_ptree)
 {}
 
+std::future<Configuration> Configuration::loadAsync(
+        Executor const & executor,
+        std::vector<std::string> tryPaths,
+        std::shared_ptr<Interpolation> interpolation,
+        LoadOptions options)
+{
+    auto promise(std::make_shared<std::promise<Configuration> >());
+    auto future(promise->get_future());
+    executor(
+        [promise,
+         tryPaths = std::move(tryPaths),
+         interpolation = std::move(interpolation),
+         options = std::move(options)]() mutable noexcept
+        {
+            try {
+                promise->set_value(
+                            Configuration(tryPaths,
+                                          std::move(interpolation),
+                                          options));
+            } catch (...) {
+                promise->set_exception(std::current_exception());
+            }
+        });
+    return future;
+}
+
+std::future<Configuration> Configuration::loadAsync(
+        Executor const & executor,
+        std::vector<std::string> tryPaths,
+        std::shared_ptr<Interpolation> interpolation)
+{
+    return loadAsync(executor,
+                     std::move(tryPaths),
+                     std::move(interpolation),
+                     LoadOptions());
+}
+
+void Configuration::loadAsync(Executor const & executor,
+                              std::vector<std::string> tryPaths,
+                              std::shared_ptr<Interpolation> interpolation,
+                              LoadOptions options,
+                              LoadCallback callback)
+{
+    assert(callback);
+    executor(
+        [tryPaths = std::move(tryPaths),
+         interpolation = std::move(interpolation),
+         options = std::move(options),
+         callback = std::move(callback)]() mutable
+        {
+            Optional<Configuration> configuration;
+            std::exception_ptr error;
+            try {
+                configuration.emplace(tryPaths,
+                                      std::move(interpolation),
+                                      options);
+            } catch (...) {
+                error = std::current_exception();
+            }
+            callback(configuration.hasValue() ? &*configuration : nullptr,
+                     std::move(error));
+        });
+}
+
 Configuration::Configuration(std::shared_ptr<Path const> path,
                              std::shared_ptr<Inner> inner,
                              ptree & ptree)
@@ -1093,9 +2760,68 @@ Configuration::interpolation() const noexcept
 void Configuration::setInterpolation(std::shared_ptr<Interpolation> i) noexcept
 { m_inner->m_interpolation = std::move(i); }
 
+void Configuration::setParsedValueCaching(bool const enable) noexcept
+{ m_inner->m_cacheParsedValues.store(enable, std::memory_order_relaxed); }
+
+bool Configuration::parsedValueCaching() const noexcept
+{ return m_inner->m_cacheParsedValues.load(std::memory_order_relaxed); }
+
+void Configuration::setAccessTracking(bool const enable) noexcept
+{ m_inner->m_trackAccesses.store(enable, std::memory_order_relaxed); }
+
+bool Configuration::accessTracking() const noexcept
+{ return m_inner->m_trackAccesses.load(std::memory_order_relaxed); }
+
+std::vector<Configuration::AccessCount> Configuration::accessReport() const {
+    std::vector<AccessCount> r;
+    Path path;
+    auto const collect =
+            [&r](TreeItem const & treeItem, Path const & itemPath) {
+                if (treeItem.hasValueItem() || treeItem.hasSectionItem())
+                    r.emplace_back(AccessCount{itemPath,
+                                               treeItem.accessCount(),
+                                               treeItem.hasValueItem(),
+                                               treeItem.hasSectionItem()});
+            };
+    forEachTreeItem(*m_ptree, path, collect);
+    std::sort(r.begin(),
+              r.end(),
+              [](AccessCount const & lhs, AccessCount const & rhs) noexcept {
+                  if (lhs.count != rhs.count)
+                      return lhs.count > rhs.count;
+                  return lhs.path.components() < rhs.path.components();
+              });
+    return r;
+}
+
+std::vector<Path> Configuration::unusedValues() const {
+    std::vector<Path> r;
+    Path path;
+    auto const collect =
+            [&r](TreeItem const & treeItem, Path const & itemPath) {
+                if (treeItem.hasValueItem() && !treeItem.accessCount())
+                    r.emplace_back(itemPath);
+            };
+    forEachTreeItem(*m_ptree, path, collect);
+    return r;
+}
+
+void Configuration::resetAccessCounts() noexcept
+{ resetSubtreeAccessCounts(*m_ptree); }
+
+Configuration::MemoryUsage Configuration::memoryUsage() const
+{ return m_inner->memoryUsage(*m_ptree); }
+
 std::string const & Configuration::filename() const noexcept
 { return m_inner->m_filename; }
 
+Configuration::LoadTimings const & Configuration::loadTimings() const noexcept
+{ return m_inner->m_loadTimings; }
+
+Configuration::LoadStatistics const & Configuration::loadStatistics()
+        const noexcept
+{ return m_inner->m_loadStatistics; }
+
 std::string const & Configuration::key() const noexcept {
     static std::string const emptyKey;
     if (!m_path || m_path->empty())
@@ -1131,7 +2857,108 @@ Configuration::ConstIterator Configuration::end() const noexcept
 Configuration::ConstIterator Configuration::cend() const noexcept
 { return ConstIterator(m_ptree->end(), *this); }
 
-void Configuration::clear() noexcept { m_ptree->clear(); }
+Configuration::ChildRange Configuration::children() const noexcept {
+    ChildTransformer const transformer(*m_inner, m_path);
+    ptree const & node = *m_ptree;
+    return ChildRange(ChildIterator(node.begin(), transformer),
+                      ChildIterator(node.end(), transformer));
+}
+
+Configuration::SortedChildRange Configuration::childrenWithPrefix(
+        StringView prefix) const
+{
+    SortedChildTransformer const transformer(*m_inner, m_path);
+    if (auto const * const index = m_inner->childIndex(*m_ptree)) {
+        auto const & sorted = index->m_sorted;
+        auto const first(
+                    std::lower_bound(
+                        sorted.begin(),
+                        sorted.end(),
+                        prefix,
+                        [](ptree::value_type const * const v,
+                           StringView const str) noexcept
+                        { return keyLess(v->first, str); }));
+        auto const last(
+                    std::partition_point(
+                        first,
+                        sorted.end(),
+                        [prefix](ptree::value_type const * const v) noexcept
+                        { return keyHasPrefix(v->first, prefix); }));
+        return SortedChildRange(SortedChildIterator(first, transformer),
+                                SortedChildIterator(last, transformer));
+    }
+    return SortedChildRange(SortedChildIterator({}, transformer),
+                            SortedChildIterator({}, transformer));
+}
+
+Configuration::SortedChildRange Configuration::childrenInRange(
+        StringView first,
+        StringView last) const
+{
+    SortedChildTransformer const transformer(*m_inner, m_path);
+    if (auto const * const index = m_inner->childIndex(*m_ptree)) {
+        auto const & sorted = index->m_sorted;
+        auto const lowerBound =
+                [](ptree::value_type const * const v,
+                   StringView const str) noexcept
+                { return keyLess(v->first, str); };
+        auto const firstIt(std::lower_bound(sorted.begin(),
+                                            sorted.end(),
+                                            first,
+                                            lowerBound));
+        auto const lastIt(std::lower_bound(firstIt,
+                                           sorted.end(),
+                                           last,
+                                           lowerBound));
+        return SortedChildRange(SortedChildIterator(firstIt, transformer),
+                                SortedChildIterator(lastIt, transformer));
+    }
+    return SortedChildRange(SortedChildIterator({}, transformer),
+                            SortedChildIterator({}, transformer));
+}
+
+Configuration::SortedSectionRange Configuration::sectionsWithPrefix(
+        StringView prefix) const
+{
+    auto const children(childrenWithPrefix(prefix));
+    return SortedSectionRange(SortedSectionIterator(children.begin(),
+                                                    children.end()),
+                              SortedSectionIterator(children.end(),
+                                                    children.end()));
+}
+
+Configuration Configuration::Match::configuration() const {
+    return Configuration(std::make_shared<Path>(m_path),
+                         m_inner->sharedFromThis(),
+                         const_cast<ptree &>(*m_node));
+}
+
+std::vector<Configuration::Match> Configuration::query(Path const & pattern)
+        const
+{
+    std::vector<Match> r;
+    if (pattern.empty())
+        return r;
+    std::vector<std::string const *> keys;
+    std::unordered_set<ptree const *> emitted;
+    auto const emit =
+            [this, &r](ptree const & node,
+                       std::vector<std::string const *> const & keys_)
+            {
+                Path path(m_path ? *m_path : Path());
+                auto & components = path.components();
+                components.reserve(components.size() + keys_.size());
+                for (auto const * const key : keys_)
+                    components.emplace_back(*key);
+                r.emplace_back(
+                        Match(*m_inner, std::move(path), node, *keys_.back()));
+            };
+    m_inner->matchPattern(*m_ptree, pattern.components(), 0u, keys, emitted,
+                          emit);
+    return r;
+}
+
+void Configuration::clear() noexcept { m_inner->clearNode(*m_ptree); }
 
 void Configuration::erase() noexcept { clear(); }
 
@@ -1139,7 +2966,7 @@ void Configuration::erase(Path const & path) noexcept {
     auto end(std::end(path.components()));
     auto it(std::begin(path.components()));
     if (it == end) {
-        m_ptree->clear();
+        m_inner->clearNode(*m_ptree);
     } else {
         auto parent(m_ptree);
         for (--end; it != end; ++it) {
@@ -1149,27 +2976,27 @@ void Configuration::erase(Path const & path) noexcept {
                 return;
             }
         }
-        parent->erase(*it);
+        m_inner->eraseChild(*parent, *it);
     }
 }
 
 void Configuration::eraseValue() noexcept {
     if (auto const & valuePtr = m_ptree->data())
-        if (valueEraser(getTreeItem(valuePtr), *m_ptree))
-            m_ptree->clear();
+        if (valueEraser(*m_inner, getTreeItem(valuePtr), *m_ptree))
+            m_inner->clearNode(*m_ptree);
 }
 
 void Configuration::eraseValue(Path const & path) noexcept
-{ erasePart(*m_ptree, path, &valueEraser); }
+{ erasePart(*m_inner, *m_ptree, path, &valueEraser); }
 
 void Configuration::eraseSection() noexcept {
     if (auto const & valuePtr = m_ptree->data())
-        if (sectionEraser(getTreeItem(valuePtr), *m_ptree))
-            m_ptree->clear();
+        if (sectionEraser(*m_inner, getTreeItem(valuePtr), *m_ptree))
+            m_inner->clearNode(*m_ptree);
 }
 
 void Configuration::eraseSection(Path const & path) noexcept
-{ erasePart(*m_ptree, path, &sectionEraser); }
+{ erasePart(*m_inner, *m_ptree, path, &sectionEraser); }
 
 std::string Configuration::interpolate(StringView value) const {
     return m_inner->m_interpolation
@@ -1215,86 +3042,327 @@ static_assert(isAlsoFixedSize<unsigned int>, "");
 static_assert(isAlsoFixedSize<signed long int>, "");
 static_assert(isAlsoFixedSize<unsigned long int>, "");
 
-bool Configuration::hasValue() const {
-    if (auto const & valuePtr = m_ptree->data())
-        return getTreeItem(valuePtr).hasValueItem();
-    return false;
-}
+bool Configuration::hasValue() const
+{ return findValueItem(*m_ptree, m_inner->readContext()); }
+
 bool Configuration::hasValue(Path const & path) const
-{ return findValueItem(*m_ptree, path); }
+{ return findValueItem(*m_ptree, path, m_inner->readContext()); }
 
-bool Configuration::hasSection() const {
-    if (auto const & valuePtr = m_ptree->data())
-        return getTreeItem(valuePtr).hasSectionItem();
-    return false;
-}
+bool Configuration::hasSection() const
+{ return hasSectionItem(*m_ptree, m_inner->readContext()); }
 
 bool Configuration::hasSection(Path const & path) const
-{ return hasSectionItem(*m_ptree, path); }
+{ return hasSectionItem(*m_ptree, path, m_inner->readContext()); }
 
 template <typename T>
 auto Configuration::value() const
         -> typename std::enable_if<isReadableValueType<T>, T>::type
-{
-    if (auto const * valueItem = findValueItem(*m_ptree))
-        return ValueHandler<T>::parse(
-                    m_inner->m_interpolation
-                    ? valueItem->interpolated(*m_inner->m_interpolation)
-                    : valueItem->m_value);
-    throw ValueNotFoundException();
-}
+{ return readValue<T>(*m_ptree, m_inner->readContext()); }
 
 template <typename T>
 auto Configuration::get(Path const & path_) const
         -> typename std::enable_if<isReadableValueType<T>, T>::type
-{
-    if (auto const * valueItem = findValueItem(*m_ptree, path_))
-        return ValueHandler<T>::parse(
-                    m_inner->m_interpolation
-                    ? valueItem->interpolated(*m_inner->m_interpolation)
-                    : valueItem->m_value);
-    throw ValueNotFoundException();
-}
+{ return readValue<T>(*m_ptree, path_, m_inner->readContext()); }
 
 template <typename T>
 auto Configuration::get(Path const & path_,
                         DefaultValueType<T> defaultValue) const
         -> typename std::enable_if<isReadableValueType<T>, T>::type
 {
-    if (auto const * valueItem = findValueItem(*m_ptree, path_))
-        return ValueHandler<T>::parse(
-                    m_inner->m_interpolation
-                    ? valueItem->interpolated(*m_inner->m_interpolation)
-                    : valueItem->m_value);
-    return ValueHandler<T>::generateDefault(defaultValue);
+    return readValue<T>(*m_ptree,
+                        path_,
+                        m_inner->readContext(),
+                        std::move(defaultValue));
+}
+
+template <typename T>
+auto Configuration::tryValue() const noexcept
+        -> typename std::enable_if<isReadableValueType<T>,
+                                   GetResult<T> >::type
+{
+    auto const context(m_inner->readContext());
+    return tryReadValueItem<T>(findValueItem(*m_ptree, context), context);
+}
+
+template <typename T>
+auto Configuration::tryGet(Path const & path_) const noexcept
+        -> typename std::enable_if<isReadableValueType<T>,
+                                   GetResult<T> >::type
+{
+    auto const context(m_inner->readContext());
+    return tryReadValueItem<T>(findValueItem(*m_ptree, path_, context),
+                               context);
 }
 
+StringView Configuration::valueView() const
+{ return readView(*m_ptree, m_inner->readContext()); }
+
+StringView Configuration::getView(Path const & path_) const
+{ return readView(*m_ptree, path_, m_inner->readContext()); }
+
+StringView Configuration::getView(Path const & path_,
+                                  StringView defaultValue) const
+{ return readView(*m_ptree, path_, m_inner->readContext(), defaultValue); }
+
+Configuration::View Configuration::view() const noexcept
+{ return View(*m_inner, *m_ptree, nullptr); }
+
 Configuration Configuration::section(Path const & path) const {
-    if (auto * child = findChild(*m_ptree, path))
-        if (auto const & valuePtr = child->data())
-            if (getTreeItem(valuePtr).hasSectionItem())
-                return Configuration(std::make_shared<Path>(*m_path + path),
-                                     m_inner,
-                                     *child);
+    if (auto * child = findChild(*m_ptree, path, m_inner->m_wideNodes))
+        if (hasSectionItem(*child, m_inner->readContext()))
+            return Configuration(std::make_shared<Path>(
+                                     joinPaths(m_path.get(), path)),
+                                 m_inner,
+                                 *child);
     throw SectionNotFoundException();
 }
 
+template <typename T>
+void Configuration::readInto(void * const out,
+                             ptree const & node,
+                             Configuration const & owner)
+{
+    assert(out);
+    *static_cast<T *>(out) =
+            readValue<T>(node, owner.m_inner->readContext());
+}
+
+void Configuration::getMany(std::vector<GetRequest> const & requests) const {
+    using RequestIndex = std::vector<GetRequest>::size_type;
+    std::vector<RequestIndex> order;
+    order.reserve(requests.size());
+    for (RequestIndex i = 0u; i < requests.size(); ++i)
+        order.emplace_back(i);
+    std::stable_sort(
+                order.begin(),
+                order.end(),
+                [&requests](RequestIndex const lhs, RequestIndex const rhs) {
+                    return requests[lhs].m_path.components()
+                           < requests[rhs].m_path.components();
+                });
+
+    /* Nodes along the path of the previous request, starting with this node.
+       Once a component is not found, the rest of the nodes are null: */
+    std::vector<ptree const *> nodes(1u, m_ptree);
+    Path::Components const * previousComponents = nullptr;
+    std::vector<GetManyException::Failure> failures;
+    for (auto const i : order) {
+        auto const & request = requests[i];
+        auto const & components = request.m_path.components();
+
+        // Reuse the lookups of the common prefix with the previous request:
+        Path::SizeType depth = 0u;
+        if (previousComponents) {
+            auto const maxDepth = std::min(previousComponents->size(),
+                                           components.size());
+            while ((depth < maxDepth)
+                   && ((*previousComponents)[depth] == components[depth]))
+                ++depth;
+        }
+        nodes.resize(depth + 1u);
+        for (; depth < components.size(); ++depth) {
+            ptree const * child = nullptr;
+            if (auto const * const parent = nodes.back())
+                child = findDirectChild(*parent,
+                                        components[depth],
+                                        m_inner->m_wideNodes);
+            nodes.emplace_back(child);
+        }
+        previousComponents = &components;
+
+        try {
+            if (auto const * const node = nodes.back()) {
+                if (!request.m_hasDefault || findValueItem(*node))
+                    request.m_reader(request.m_out, *node, *this);
+            } else if (!request.m_hasDefault) {
+                throw ValueNotFoundException();
+            }
+        } catch (...) {
+            failures.emplace_back(
+                        GetManyException::Failure{request.m_path,
+                                                  std::current_exception()});
+        }
+    }
+    if (!failures.empty())
+        throw GetManyException(std::move(failures));
+}
+
+template <typename T>
+void Configuration::validateValue(ptree const & node,
+                                  Configuration const & owner,
+                                  void const * const check)
+{
+    auto context(owner.m_inner->readContext());
+    context.trackAccesses = false; // Validation is not a use of the value
+    auto const * const valueItem = findValueItem(node);
+    if (!valueItem)
+        throw ValueNotFoundException();
+    auto const value(parseValueItem<T>(*valueItem, context));
+    using Check = std::function<bool (T const &)>;
+    if (check && !(*static_cast<Check const *>(check))(value))
+        throw InvalidValueException();
+}
+
+void Configuration::validate(std::vector<ValidationRule> const & rules,
+                             Executor const & executor,
+                             std::size_t const parallelism) const
+{
+    // The number of values claimed by a thread at a time:
+    constexpr std::size_t const batchSize = 64u;
+
+    struct Item {
+        ValidationRule const * rule;
+        Path path;
+        ptree const * node; // Null if a required rule matched nothing
+    };
+
+    /* Tasks started by the executor only after all items were validated by
+       others may outlive this call, hence they share ownership of the state,
+       and only access the items they claim: */
+    struct State {
+        std::vector<Item> items;
+        std::vector<std::exception_ptr> errors;
+        std::atomic<std::size_t> next{0u};
+        std::size_t done = 0u;
+        std::mutex mutex;
+        std::condition_variable doneCondition;
+    };
+
+    auto const state(std::make_shared<State>());
+    auto & items = state->items;
+    auto & errors = state->errors;
+    for (auto const & rule : rules) {
+        auto matches(query(rule.m_pattern));
+        if (matches.empty() && rule.m_required)
+            items.emplace_back(Item{&rule, rule.m_pattern, nullptr});
+        for (auto & match : matches)
+            items.emplace_back(Item{&rule,
+                                    std::move(match.m_path),
+                                    match.m_node});
+    }
+    auto const size = items.size();
+    errors.resize(size);
+    for (std::size_t i = 0u; i < size; ++i)
+        if (!items[i].node)
+            errors[i] = std::make_exception_ptr(ValueNotFoundException());
+
+    auto const work =
+            [state, this]() noexcept {
+                auto & s = *state;
+                auto const numItems = s.items.size();
+                std::size_t validated = 0u;
+                for (;;) {
+                    auto const begin =
+                            s.next.fetch_add(batchSize,
+                                             std::memory_order_relaxed);
+                    if (begin >= numItems)
+                        break;
+                    auto const end = std::min(begin + batchSize, numItems);
+                    for (auto i = begin; i < end; ++i) {
+                        auto const & item = s.items[i];
+                        if (!item.node)
+                            continue;
+                        try {
+                            item.rule->m_validator(*item.node,
+                                                   *this,
+                                                   item.rule->m_check.get());
+                        } catch (...) {
+                            s.errors[i] = std::current_exception();
+                        }
+                    }
+                    validated += end - begin;
+                }
+                if (validated) {
+                    std::lock_guard<std::mutex> const guard(s.mutex);
+                    s.done += validated;
+                    if (s.done == numItems)
+                        s.doneCondition.notify_all();
+                }
+            };
+
+    // The calling thread validates values as well:
+    auto const tasks = std::min(parallelism,
+                                (size + batchSize - 1u) / batchSize);
+    for (std::size_t i = 1u; i < tasks; ++i) {
+        try {
+            executor(work);
+        } catch (...) {
+            break; // Validate the rest with fewer threads
+        }
+    }
+    work();
+    {
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->doneCondition.wait(lock,
+                                  [&state, size]() noexcept
+                                  { return state->done == size; });
+    }
+
+    std::vector<ValidationException::Failure> failures;
+    for (std::size_t i = 0u; i < size; ++i) {
+        if (!errors[i])
+            continue;
+        auto & item = items[i];
+        ValidationException::Failure failure{std::move(item.path),
+                                             std::string(),
+                                             0u,
+                                             std::move(errors[i])};
+        if (item.node) {
+            if (auto const * const valueItem = findValueItem(*item.node)) {
+                auto const & context = valueItem->m_context;
+                failure.filename = context.m_filename->string();
+                failure.lineNumber = context.m_lineNumber.get();
+            }
+        }
+        failures.emplace_back(std::move(failure));
+    }
+    if (!failures.empty())
+        throw ValidationException(std::move(failures));
+}
+
+void Configuration::validate(std::vector<ValidationRule> const & rules) const
+{
+    std::vector<std::thread> threads;
+    auto const joinThreads =
+            [&threads]() noexcept {
+                for (auto & thread : threads)
+                    thread.join();
+            };
+    try {
+        validate(rules,
+                 [&threads](std::function<void ()> task)
+                 { threads.emplace_back(std::move(task)); },
+                 std::max(std::thread::hardware_concurrency(), 1u));
+    } catch (...) {
+        joinThreads();
+        throw;
+    }
+    joinThreads();
+}
+
 #define DEFINE_GETTERS(T) \
     template T Configuration::value<T>() const; \
     template T Configuration::get<T>(Path const &) const; \
-    template T Configuration::get<T>(Path const &, DefaultValueType<T>) const
-DEFINE_GETTERS(std::string);
-DEFINE_GETTERS(std::int8_t);
-DEFINE_GETTERS(std::int16_t);
-DEFINE_GETTERS(std::int32_t);
-DEFINE_GETTERS(std::int64_t);
-DEFINE_GETTERS(std::uint8_t);
-DEFINE_GETTERS(std::uint16_t);
-DEFINE_GETTERS(std::uint32_t);
-DEFINE_GETTERS(std::uint64_t);
-DEFINE_GETTERS(float);
-DEFINE_GETTERS(double);
-DEFINE_GETTERS(long double);
+    template T Configuration::get<T>(Path const &, DefaultValueType<T>) const; \
+    template Configuration::GetResult<T> \
+    Configuration::tryValue<T>() const noexcept; \
+    template Configuration::GetResult<T> \
+    Configuration::tryGet<T>(Path const &) const noexcept; \
+    template T Configuration::View::value<T>() const; \
+    template T Configuration::View::get<T>(Path const &) const; \
+    template T Configuration::View::get<T>(Path const &, \
+                                           DefaultValueType<T>) const; \
+    template Configuration::GetResult<T> \
+    Configuration::View::tryValue<T>() const noexcept; \
+    template Configuration::GetResult<T> \
+    Configuration::View::tryGet<T>(Path const &) const noexcept; \
+    template void Configuration::readInto<T>(void *, \
+                                             ptree const &, \
+                                             Configuration const &); \
+    template void Configuration::validateValue<T>(ptree const &, \
+                                                  Configuration const &, \
+                                                  void const *);
+SHAREMIND_LIBCONFIGURATION_FOR_EACH_VALUE_TYPE(DEFINE_GETTERS)
 #undef DEFINE_GETTERS
 
 } /* namespace sharemind { */
@@ -20,11 +20,17 @@
 #ifndef SHAREMIND_LIBCONFIGURATION_CONFIGURATION_H
 #define SHAREMIND_LIBCONFIGURATION_CONFIGURATION_H
 
+#include <atomic>
+#include <boost/iterator/filter_iterator.hpp>
 #include <boost/iterator/transform_iterator.hpp>
 #include <boost/property_tree/ptree.hpp>
+#include <chrono>
 #include <ctime>
 #include <cstdint>
 #include <exception>
+#include <functional>
+#include <future>
+#include <limits>
 #include <memory>
 #include <sharemind/Exception.h>
 #include <sharemind/ExceptionMacros.h>
@@ -35,8 +41,50 @@
 #include <type_traits>
 #include <utility>
 #include <vector>
-#include <unordered_map>
+#include "ByteSize.h"
 #include "Path.h"
+#include "StringHashMap.h"
+
+/* Invokes F(T) for every readable value type T of Configuration: */
+#define SHAREMIND_LIBCONFIGURATION_FOR_EACH_VALUE_TYPE(F) \
+    F(std::string) \
+    F(std::int8_t) \
+    F(std::int16_t) \
+    F(std::int32_t) \
+    F(std::int64_t) \
+    F(std::uint8_t) \
+    F(std::uint16_t) \
+    F(std::uint32_t) \
+    F(std::uint64_t) \
+    F(float) \
+    F(double) \
+    F(long double) \
+    F(sharemind::ByteSize) \
+    F(std::chrono::nanoseconds) \
+    F(std::chrono::microseconds) \
+    F(std::chrono::milliseconds) \
+    F(std::chrono::seconds) \
+    F(std::chrono::minutes) \
+    F(std::chrono::hours) \
+    F(std::vector<std::string>) \
+    F(std::vector<std::int8_t>) \
+    F(std::vector<std::int16_t>) \
+    F(std::vector<std::int32_t>) \
+    F(std::vector<std::int64_t>) \
+    F(std::vector<std::uint8_t>) \
+    F(std::vector<std::uint16_t>) \
+    F(std::vector<std::uint32_t>) \
+    F(std::vector<std::uint64_t>) \
+    F(std::vector<float>) \
+    F(std::vector<double>) \
+    F(std::vector<long double>) \
+    F(std::vector<sharemind::ByteSize>) \
+    F(std::vector<std::chrono::nanoseconds>) \
+    F(std::vector<std::chrono::microseconds>) \
+    F(std::vector<std::chrono::milliseconds>) \
+    F(std::vector<std::chrono::seconds>) \
+    F(std::vector<std::chrono::minutes>) \
+    F(std::vector<std::chrono::hours>)
 
 
 namespace sharemind {
@@ -80,7 +128,7 @@ private: /* Types: */
 public: /* Types: */
 
     template <typename T>
-    static constexpr bool const isReadableValueType =
+    static constexpr bool const isReadableScalarValueType =
             std::is_same<T, std::string>::value
             || std::is_same<T, std::int8_t>::value
             || std::is_same<T, std::int16_t>::value
@@ -92,7 +140,40 @@ public: /* Types: */
             || std::is_same<T, std::uint64_t>::value
             || std::is_same<T, float>::value
             || std::is_same<T, double>::value
-            || std::is_same<T, long double>::value;
+            || std::is_same<T, long double>::value
+            || std::is_same<T, ByteSize>::value
+            || std::is_same<T, std::chrono::nanoseconds>::value
+            || std::is_same<T, std::chrono::microseconds>::value
+            || std::is_same<T, std::chrono::milliseconds>::value
+            || std::is_same<T, std::chrono::seconds>::value
+            || std::is_same<T, std::chrono::minutes>::value
+            || std::is_same<T, std::chrono::hours>::value;
+
+    template <typename T>
+    struct IsReadableListValueType: std::false_type {};
+
+    template <typename T>
+    struct IsReadableListValueType<std::vector<T> >
+        : std::integral_constant<bool, isReadableScalarValueType<T> >
+    {};
+
+    /**
+      Durations are read from values consisting of a non-negative integer
+      followed by an optional unit suffix, which is one of "ns", "us" (or
+      "\u00b5s"), "ms", "s", "min", "h" and "d". Values without a suffix are in
+      the units of the requested duration type. Values which can not be
+      represented exactly in the units of the requested type, e.g. "1500us"
+      read as std::chrono::milliseconds, are rejected. See ByteSize for the
+      format of byte sizes.
+
+      Lists of values, i.e. std::vector<T> for any readable scalar value type
+      T, are read from values consisting of elements separated either by
+      commas or, for values without commas, by whitespace.
+    */
+    template <typename T>
+    static constexpr bool const isReadableValueType =
+            isReadableScalarValueType<T>
+            || IsReadableListValueType<T>::value;
 
     template <typename T>
     using DefaultValueType =
@@ -125,6 +206,8 @@ public: /* Types: */
                                                    SectionNotFoundException);
     SHAREMIND_DECLARE_EXCEPTION_CONST_MSG_NOINLINE(Exception,
                                                    FailedToParseValueException);
+    SHAREMIND_DECLARE_EXCEPTION_CONST_MSG_NOINLINE(Exception,
+                                                   InvalidValueException);
     SHAREMIND_DECLARE_EXCEPTION_CONST_MSG_NOINLINE(Exception, GlobException);
     SHAREMIND_DECLARE_EXCEPTION_CONST_MSG_NOINLINE(Exception,
                                                    IncludeLoopException);
@@ -146,6 +229,18 @@ public: /* Types: */
     SHAREMIND_DECLARE_EXCEPTION_CONST_MSG_NOINLINE(
             Exception,
             IncludeDirectiveMissingArgumentException);
+    SHAREMIND_DECLARE_EXCEPTION_CONST_MSG_NOINLINE(Exception,
+                                                   LoadCancelledException);
+    SHAREMIND_DECLARE_EXCEPTION_NOINLINE(Exception, LoadLimitException);
+    SHAREMIND_DECLARE_EXCEPTION_CONST_MSG_NOINLINE(LoadLimitException,
+                                                   LineTooLongException);
+    SHAREMIND_DECLARE_EXCEPTION_CONST_MSG_NOINLINE(LoadLimitException,
+                                                   FileTooLargeException);
+    SHAREMIND_DECLARE_EXCEPTION_CONST_MSG_NOINLINE(LoadLimitException,
+                                                   IncludeTooDeepException);
+    SHAREMIND_DECLARE_EXCEPTION_CONST_MSG_NOINLINE(
+            LoadLimitException,
+            TooManyIncludedFilesException);
 
     using Iterator =
             boost::transform_iterator<IteratorTransformer, ptree::iterator>;
@@ -154,6 +249,473 @@ public: /* Types: */
             boost::transform_iterator<ConstIteratorTransformer,
                                       ptree::const_iterator>;
 
+    /** \brief The reasons why tryValue() and tryGet() may fail. */
+    enum class GetError {
+        None,
+        ValueNotFound,
+        InterpolationFailed,
+        ParseFailed,
+        OutOfMemory
+    };
+
+    /** \brief The result of tryValue() and tryGet(), a value or an error. */
+    template <typename T>
+    class GetResult {
+
+    public: /* Methods: */
+
+        GetResult(GetError const error) noexcept : m_error(error) {}
+
+        GetResult(T && value) noexcept
+            : m_value(std::move(value))
+            , m_error(GetError::None)
+        {}
+
+        bool hasValue() const noexcept { return m_error == GetError::None; }
+        explicit operator bool() const noexcept { return hasValue(); }
+
+        GetError error() const noexcept { return m_error; }
+
+        /** \pre hasValue() */
+        T & value() & noexcept { return m_value; }
+        T const & value() const & noexcept { return m_value; }
+        T && value() && noexcept { return std::move(m_value); }
+
+        T & operator*() & noexcept { return m_value; }
+        T const & operator*() const & noexcept { return m_value; }
+        T && operator*() && noexcept { return std::move(m_value); }
+
+        T * operator->() noexcept { return &m_value; }
+        T const * operator->() const noexcept { return &m_value; }
+
+    private: /* Fields: */
+
+        T m_value{};
+        GetError m_error;
+
+    }; /* class GetResult */
+
+    class ViewTransformer;
+
+    /**
+      \brief A trivially copyable non-owning view of a node of a loaded
+             configuration, providing the read-only API of Configuration.
+
+      Unlike Configuration objects, views neither store their path nor share
+      ownership of the loaded configuration, so copying them involves no
+      allocations or reference count updates.
+
+      \warning Views are only valid as long as some Configuration object
+               sharing the loaded configuration is alive and the node the
+               view refers to is not erased.
+    */
+    class View {
+
+        friend class Configuration;
+        friend class ViewTransformer;
+
+    public: /* Types: */
+
+        using Iterator =
+                boost::transform_iterator<ViewTransformer,
+                                          ptree::const_iterator>;
+
+    public: /* Methods: */
+
+        /**
+          \returns the key of this node if this view was obtained via
+                   iteration or section(), otherwise an empty string.
+        */
+        std::string const & key() const noexcept;
+
+        bool empty() const noexcept;
+        SizeType size() const noexcept;
+
+        /** \returns an iterator over views of the direct children. */
+        Iterator begin() const noexcept;
+        Iterator end() const noexcept;
+
+        bool hasValue() const;
+        bool hasValue(Path const & path) const;
+        bool hasSection() const;
+        bool hasSection(Path const & path) const;
+
+        template <typename T>
+        auto value() const
+                -> typename std::enable_if<isReadableValueType<T>, T>::type;
+
+        template <typename T>
+        auto get(Path const & path_) const
+                -> typename std::enable_if<isReadableValueType<T>, T>::type;
+
+        template <typename T>
+        auto get(Path const & path_, DefaultValueType<T> defaultValue) const
+                -> typename std::enable_if<isReadableValueType<T>, T>::type;
+
+        template <typename T>
+        auto tryValue() const noexcept
+                -> typename std::enable_if<isReadableValueType<T>,
+                                           GetResult<T> >::type;
+
+        template <typename T>
+        auto tryGet(Path const & path_) const noexcept
+                -> typename std::enable_if<isReadableValueType<T>,
+                                           GetResult<T> >::type;
+
+        StringView valueView() const;
+        StringView getView(Path const & path_) const;
+        StringView getView(Path const & path_, StringView defaultValue) const;
+
+        /** \throws SectionNotFoundException */
+        View section(Path const & path) const;
+
+    protected: /* Methods: */
+
+        View(Inner const & inner,
+             ptree const & node,
+             std::string const * key) noexcept
+            : m_inner(&inner)
+            , m_node(&node)
+            , m_key(key)
+        {}
+
+    protected: /* Fields: */
+
+        Inner const * m_inner;
+        ptree const * m_node;
+        std::string const * m_key;
+
+    }; /* class View */
+
+    class ViewTransformer {
+
+    public: /* Types: */
+
+        using result_type = View;
+
+    public: /* Methods: */
+
+        ViewTransformer(Inner const & inner) noexcept : m_inner(&inner) {}
+
+        View operator()(ptree::value_type const & value) const noexcept
+        { return View(*m_inner, value.second, &value.first); }
+
+    private: /* Fields: */
+
+        Inner const * m_inner;
+
+    };
+
+    /**
+      \brief A view of a direct child of a Configuration object, which also
+             knows the path of the child.
+
+      Unlike Configuration objects obtained via Iterator and ConstIterator,
+      these handles neither copy the path of their parent nor share ownership
+      of the loaded configuration. The path of the child is only materialized
+      when path() is called.
+
+      \warning Handles are only valid as long as some Configuration object
+               sharing the loaded configuration is alive and the configuration
+               is not modified. The path of the parent used by path() and
+               configuration() is kept alive by the range the handles were
+               obtained from and by the parent Configuration object.
+    */
+    class Child: public View {
+
+        friend class Configuration;
+
+    public: /* Methods: */
+
+        Path path() const;
+
+        /** \returns a regular Configuration object for this child. */
+        Configuration configuration() const;
+
+    private: /* Methods: */
+
+        Child(Inner const & inner,
+              Path const * parentPath,
+              ptree::value_type const & value) noexcept
+            : View(inner, value.second, &value.first)
+            , m_parentPath(parentPath)
+        {}
+
+    private: /* Fields: */
+
+        Path const * m_parentPath; // Null for children of the root
+
+    }; /* class Child */
+
+    class ChildTransformer {
+
+    public: /* Types: */
+
+        using result_type = Child;
+
+    public: /* Methods: */
+
+        ChildTransformer(Inner const & inner,
+                         std::shared_ptr<Path const> parentPath) noexcept
+            : m_inner(&inner)
+            , m_parentPath(std::move(parentPath))
+        {}
+
+        Child operator()(ptree::value_type const & value) const noexcept
+        { return Child(*m_inner, m_parentPath.get(), value); }
+
+    private: /* Fields: */
+
+        Inner const * m_inner;
+        std::shared_ptr<Path const> m_parentPath;
+
+    };
+
+    using ChildIterator =
+            boost::transform_iterator<ChildTransformer, ptree::const_iterator>;
+
+    template <typename Iterator>
+    class IteratorRange {
+
+    public: /* Methods: */
+
+        IteratorRange(Iterator begin_, Iterator end_) noexcept
+            : m_begin(std::move(begin_))
+            , m_end(std::move(end_))
+        {}
+
+        Iterator begin() const noexcept { return m_begin; }
+        Iterator end() const noexcept { return m_end; }
+
+        bool empty() const noexcept { return m_begin == m_end; }
+
+    private: /* Fields: */
+
+        Iterator m_begin;
+        Iterator m_end;
+
+    };
+
+    using ChildRange = IteratorRange<ChildIterator>;
+
+    class SortedChildTransformer {
+
+    public: /* Types: */
+
+        using result_type = Child;
+
+    public: /* Methods: */
+
+        SortedChildTransformer(Inner const & inner,
+                               std::shared_ptr<Path const> parentPath)
+                noexcept
+            : m_inner(&inner)
+            , m_parentPath(std::move(parentPath))
+        {}
+
+        Child operator()(ptree::value_type const * value) const noexcept
+        { return Child(*m_inner, m_parentPath.get(), *value); }
+
+    private: /* Fields: */
+
+        Inner const * m_inner;
+        std::shared_ptr<Path const> m_parentPath;
+
+    };
+
+    using SortedChildIterator =
+            boost::transform_iterator<
+                SortedChildTransformer,
+                std::vector<ptree::value_type const *>::const_iterator>;
+
+    using SortedChildRange = IteratorRange<SortedChildIterator>;
+
+    struct IsSectionPredicate {
+        bool operator()(Child const & child) const
+        { return child.hasSection(); }
+    };
+
+    using SortedSectionIterator =
+            boost::filter_iterator<IsSectionPredicate, SortedChildIterator>;
+
+    using SortedSectionRange = IteratorRange<SortedSectionIterator>;
+
+    /**
+      \brief A result of query(), consisting of the matched path and a view
+             of the matched node.
+      \warning Valid only as long as some Configuration object sharing the
+               loaded configuration is alive and the configuration is not
+               modified.
+    */
+    class Match: public View {
+
+        friend class Configuration;
+
+    public: /* Methods: */
+
+        Path const & path() const noexcept { return m_path; }
+
+        /** \returns a regular Configuration object for the matched node. */
+        Configuration configuration() const;
+
+    private: /* Methods: */
+
+        Match(Inner const & inner,
+              Path path,
+              ptree const & node,
+              std::string const & key) noexcept
+            : View(inner, node, &key)
+            , m_path(std::move(path))
+        {}
+
+    private: /* Fields: */
+
+        Path m_path;
+
+    }; /* class Match */
+
+    class Interpolation;
+
+    /** \brief Describes a single value to be read by getMany(). */
+    class GetRequest {
+
+        friend class Configuration;
+
+    private: /* Types: */
+
+        using Reader = void (*)(void * out,
+                                ptree const & node,
+                                Configuration const & owner);
+
+    public: /* Methods: */
+
+        Path const & path() const noexcept { return m_path; }
+        bool hasDefault() const noexcept { return m_hasDefault; }
+
+    private: /* Methods: */
+
+        GetRequest(Path path, void * out, Reader reader, bool hasDefault)
+                noexcept
+            : m_path(std::move(path))
+            , m_out(out)
+            , m_reader(reader)
+            , m_hasDefault(hasDefault)
+        {}
+
+    private: /* Fields: */
+
+        Path m_path;
+        void * m_out;
+        Reader m_reader;
+        bool m_hasDefault;
+
+    }; /* class GetRequest */
+
+    /** \brief Thrown by getMany() to report all failed requests at once. */
+    class GetManyException: public Exception {
+
+    public: /* Types: */
+
+        struct Failure {
+            Path path;
+            std::exception_ptr exception;
+        };
+
+    public: /* Methods: */
+
+        GetManyException(std::vector<Failure> failures);
+        GetManyException(GetManyException &&) noexcept;
+        GetManyException(GetManyException const &) noexcept;
+        ~GetManyException() noexcept override;
+
+        GetManyException & operator=(GetManyException &&) noexcept;
+        GetManyException & operator=(GetManyException const &) noexcept;
+
+        char const * what() const noexcept override;
+
+        std::vector<Failure> const & failures() const noexcept;
+
+    private: /* Fields: */
+
+        struct Data;
+        std::shared_ptr<Data const> m_data;
+
+    }; /* class GetManyException */
+
+    /** \brief Describes the values to be checked by validate(). */
+    class ValidationRule {
+
+        friend class Configuration;
+
+    private: /* Types: */
+
+        using Validator = void (*)(ptree const & node,
+                                   Configuration const & owner,
+                                   void const * check);
+
+    public: /* Methods: */
+
+        Path const & pattern() const noexcept { return m_pattern; }
+        bool isRequired() const noexcept { return m_required; }
+
+    private: /* Methods: */
+
+        ValidationRule(Path pattern,
+                       Validator validator,
+                       std::shared_ptr<void const> check,
+                       bool required) noexcept
+            : m_pattern(std::move(pattern))
+            , m_validator(validator)
+            , m_check(std::move(check))
+            , m_required(required)
+        {}
+
+    private: /* Fields: */
+
+        Path m_pattern;
+        Validator m_validator;
+        std::shared_ptr<void const> m_check;
+        bool m_required;
+
+    }; /* class ValidationRule */
+
+    /** \brief Thrown by validate() to report all invalid values at once. */
+    class ValidationException: public Exception {
+
+    public: /* Types: */
+
+        struct Failure {
+            /** \brief The path of the value, or the pattern of a required
+                       rule which matched nothing. */
+            Path path;
+            /** \brief The file the value was loaded from, if any. */
+            std::string filename;
+            /** \brief The line of the value in that file, or zero. */
+            std::size_t lineNumber;
+            std::exception_ptr exception;
+        };
+
+    public: /* Methods: */
+
+        ValidationException(std::vector<Failure> failures);
+        ValidationException(ValidationException &&) noexcept;
+        ValidationException(ValidationException const &) noexcept;
+        ~ValidationException() noexcept override;
+
+        ValidationException & operator=(ValidationException &&) noexcept;
+        ValidationException & operator=(ValidationException const &) noexcept;
+
+        char const * what() const noexcept override;
+
+        std::vector<Failure> const & failures() const noexcept;
+
+    private: /* Fields: */
+
+        struct Data;
+        std::shared_ptr<Data const> m_data;
+
+    }; /* class ValidationException */
+
     class Interpolation {
 
     public: /* Types: */
@@ -183,8 +745,21 @@ public: /* Types: */
         std::string interpolate(StringView s) const;
         std::string interpolate(StringView s, ::tm const & theTime) const;
 
+        /**
+          \brief Registers an interpolation variable, unless a variable with
+                 the same name has already been registered.
+        */
         void addVariable(std::string var, std::string value);
 
+        /**
+          \brief Like addVariable(var, value), but uses the given precomputed
+                 hash of the variable name.
+          \pre varHash == stringHash(var)
+        */
+        void addVariable(std::string var,
+                         std::size_t varHash,
+                         std::string value);
+
         void resetTime();
         void resetTime(std::time_t theTime);
         void resetTime(::tm const & theTime);
@@ -192,13 +767,160 @@ public: /* Types: */
         static ::tm getLocalTimeTm();
         static ::tm getLocalTimeTm(std::time_t theTime);
 
+        /** \returns the heap memory used by the registered variables. */
+        std::size_t memoryUsage() const noexcept;
+
     private: /* Fields: */
 
-        std::unordered_map<std::string, std::string> m_map;
+        StringHashMap<std::string> m_map;
         ::tm m_time;
 
     }; /* class Interpolation */
 
+    /** \brief Wall-clock time spent in the phases of loading a configuration. */
+    struct LoadTimings {
+        /** \brief The whole load, including the phases below. */
+        std::chrono::nanoseconds total{};
+        /** \brief Expanding and sorting the @include patterns. */
+        std::chrono::nanoseconds glob{};
+        /** \brief Resolving the canonical paths of the files. */
+        std::chrono::nanoseconds canonicalize{};
+        /** \brief Opening the files and checking for include loops. */
+        std::chrono::nanoseconds open{};
+        /** \brief Reading from the files. */
+        std::chrono::nanoseconds read{};
+        /** \brief Tokenizing and building the tree, excluding reads. */
+        std::chrono::nanoseconds parse{};
+        /** \brief Building the hash indexes of sections with many keys. */
+        std::chrono::nanoseconds index{};
+    };
+
+    /** \brief Statistics about a single file parsed during loading. */
+    struct LoadedFileStatistics {
+        /** \brief The canonical path of the file. */
+        std::string path;
+        std::uint64_t bytes = 0u;
+        std::uint64_t lines = 0u;
+        /** \brief The number of key-value pairs defined in the file. */
+        std::uint64_t keys = 0u;
+        std::uint64_t sections = 0u;
+        /** \brief Zero for the top-level file, one for files it includes etc. */
+        std::size_t includeDepth = 0u;
+        /**
+          \brief Wall-clock time spent opening, reading and parsing the file,
+                 excluding the files it includes.
+        */
+        std::chrono::nanoseconds wallTime{};
+    };
+
+    /**
+      \brief Statistics about the files parsed during loading, which complement
+             the per-phase timings given by loadTimings().
+    */
+    struct LoadStatistics {
+        /** \brief Statistics of the parsed files, in the order opened. */
+        std::vector<LoadedFileStatistics> files;
+        std::uint64_t bytes = 0u;
+        std::uint64_t lines = 0u;
+        std::uint64_t keys = 0u;
+        std::uint64_t sections = 0u;
+        /** \brief The number of @include directives processed. */
+        std::uint64_t includeDirectives = 0u;
+        std::size_t maxIncludeDepth = 0u;
+    };
+
+    /** \brief Options for loading a configuration. */
+    struct LoadOptions {
+        /**
+          \brief If not null, the load is aborted with a LoadCancelledException
+                 soon after the flag is set.
+        */
+        std::shared_ptr<std::atomic<bool> const> cancellationFlag;
+
+        /**
+          \brief Whether to read the files matched by @include directives into
+                 the page cache on a background thread while parsing, which
+                 helps to hide latencies of cold caches and slow file systems.
+        */
+        bool prefetchIncludes = false;
+
+        /**
+          \brief Whether to read the files matched by each @include directive
+                 in batches using Linux io_uring, which saves system calls
+                 when including many files. If io_uring is not available,
+                 the files are read one by one as usual.
+        */
+        bool useIoUring = false;
+
+        /**
+          \brief Whether to collect the statistics returned by
+                 loadStatistics(). This costs a few counter increments per
+                 line and a small record per file.
+        */
+        bool collectStatistics = false;
+
+        /* Limits on the input, exceeding which fails the load with a
+           LoadLimitException before reading any further. By default, there
+           are no limits. */
+
+        /** \brief The maximum length of a line, excluding the newline. */
+        std::size_t maxLineLength = std::numeric_limits<std::size_t>::max();
+
+        /** \brief The maximum size of any single file, in bytes. */
+        std::uint64_t maxFileSize = std::numeric_limits<std::uint64_t>::max();
+
+        /**
+          \brief The maximum nesting depth of @include directives, zero
+                 disallowing them altogether.
+        */
+        std::size_t maxIncludeDepth = std::numeric_limits<std::size_t>::max();
+
+        /** \brief The maximum total number of files included. */
+        std::size_t maxIncludedFiles = std::numeric_limits<std::size_t>::max();
+    };
+
+    /**
+      \brief An estimate of the heap memory used by a configuration, in bytes,
+             excluding the overhead of the memory allocator.
+    */
+    struct MemoryUsage {
+        /** \brief Tree nodes, their indexes and per-node data. */
+        std::size_t structure = 0u;
+        /** \brief Keys too long to be stored inline. */
+        std::size_t keys = 0u;
+        /** \brief Values and the parsed and interpolated values cached. */
+        std::size_t values = 0u;
+        /** \brief Names of the files the values were loaded from. */
+        std::size_t contexts = 0u;
+        /** \brief Interpolation variables, shared by the whole tree. */
+        std::size_t interpolation = 0u;
+
+        std::size_t total() const noexcept
+        { return structure + keys + values + contexts + interpolation; }
+    };
+
+    /** \brief The number of reads of a value or section, see accessReport(). */
+    struct AccessCount {
+        /** \brief The path relative to the queried (sub)configuration. */
+        Path path;
+        std::uint64_t count;
+        bool hasValue;
+        bool hasSection;
+    };
+
+    /** \brief Runs the given task, e.g. by submitting it to a thread pool. */
+    using Executor = std::function<void (std::function<void ()>)>;
+
+    /**
+      \brief Receives the result of an asynchronous load. On success the
+             configuration argument points to the loaded configuration, which
+             the callback may move from, and the error is null. Otherwise the
+             configuration argument is null and the error holds the exception.
+    */
+    using LoadCallback =
+            std::function<void (Configuration * configuration,
+                                std::exception_ptr error)>;
+
 public: /* Methods: */
 
     Configuration(Configuration && move) noexcept;
@@ -214,18 +936,108 @@ public: /* Methods: */
     Configuration(std::vector<std::string> const & tryPaths,
                   std::shared_ptr<Interpolation> interpolation);
 
+    Configuration(StringView filename,
+                  std::shared_ptr<Interpolation> interpolation,
+                  LoadOptions const & options);
+
+    Configuration(std::vector<std::string> const & tryPaths,
+                  std::shared_ptr<Interpolation> interpolation,
+                  LoadOptions const & options);
+
     virtual ~Configuration() noexcept;
 
+    /**
+      \brief Loads a configuration like the constructor taking try paths, but
+             does so in a task run by the given executor.
+      \returns a future for the loaded configuration.
+    */
+    static std::future<Configuration> loadAsync(
+            Executor const & executor,
+            std::vector<std::string> tryPaths,
+            std::shared_ptr<Interpolation> interpolation,
+            LoadOptions options);
+
+    /**
+      \brief Like loadAsync(executor, tryPaths, interpolation, options), but
+             with the default load options.
+    */
+    static std::future<Configuration> loadAsync(
+            Executor const & executor,
+            std::vector<std::string> tryPaths,
+            std::shared_ptr<Interpolation> interpolation);
+
+    /**
+      \brief Like loadAsync(executor, tryPaths, interpolation, options), but
+             passes the result to the given callback in the executor task.
+    */
+    static void loadAsync(Executor const & executor,
+                          std::vector<std::string> tryPaths,
+                          std::shared_ptr<Interpolation> interpolation,
+                          LoadOptions options,
+                          LoadCallback callback);
+
     Configuration & operator=(Configuration && move) noexcept;
     Configuration & operator=(Configuration const & copy);
 
     std::shared_ptr<Interpolation> const & interpolation() const noexcept;
     void setInterpolation(std::shared_ptr<Interpolation> i) noexcept;
 
+    /**
+      \brief Enables or disables caching of parsed values for the whole loaded
+             configuration.
+
+      When enabled, values which are not subject to interpolation are parsed
+      at most once per requested type, e.g. lists are split and their elements
+      converted only on the first read. Subsequent reads return copies of the
+      cached results. Caching is disabled by default.
+    */
+    void setParsedValueCaching(bool enable) noexcept;
+    bool parsedValueCaching() const noexcept;
+
+    /**
+      \brief Enables or disables counting reads of values and sections for the
+             whole loaded configuration.
+
+      When enabled, every hasValue(), hasSection(), value(), get(), tryGet(),
+      getView() and section() call, including those of children and views,
+      increments a relaxed atomic counter on the node it reads. Tracking is
+      disabled by default, in which case it costs a single flag check per read.
+      Copies of the configuration share their counters.
+    */
+    void setAccessTracking(bool enable) noexcept;
+    bool accessTracking() const noexcept;
+
+    /**
+      \returns the access counts of all values and sections in this (sub)tree,
+               sorted by decreasing count and then by path.
+    */
+    std::vector<AccessCount> accessReport() const;
+
+    /** \returns the paths of the values in this (sub)tree never read. */
+    std::vector<Path> unusedValues() const;
+
+    /** \brief Resets the access counts of all nodes in this (sub)tree. */
+    void resetAccessCounts() noexcept;
+
     /** \returns the path of the file from which the root of the configuration
                  was loaded from. */
     std::string const & filename() const noexcept;
 
+    /**
+      \returns an estimate of the heap memory used by this (sub)tree. Memory
+               shared with other subtrees, e.g. file names, is included.
+    */
+    MemoryUsage memoryUsage() const;
+
+    /** \returns the time spent in the phases of loading this configuration. */
+    LoadTimings const & loadTimings() const noexcept;
+
+    /**
+      \returns the statistics collected while loading this configuration, which
+               are empty unless requested with LoadOptions::collectStatistics.
+    */
+    LoadStatistics const & loadStatistics() const noexcept;
+
     std::string const & key() const noexcept;
 
     Path const & path() const noexcept;
@@ -241,6 +1053,34 @@ public: /* Methods: */
     ConstIterator end() const noexcept;
     ConstIterator cend() const noexcept;
 
+    /**
+      \returns a range of lightweight handles to the direct children of this
+               configuration, which can be iterated over without allocating
+               memory or modifying reference counts.
+    */
+    ChildRange children() const noexcept;
+
+    /**
+      \returns handles to the direct children with keys starting with the given
+               prefix, ordered by key. The lookup uses a sorted index of the
+               keys, hence its cost is logarithmic in the number of children
+               plus linear in the number of matches. The index is built on
+               the first such lookup in this section.
+    */
+    SortedChildRange childrenWithPrefix(StringView prefix) const;
+
+    /**
+      \returns handles to the direct children with keys in the half-open range
+               [first, last), ordered by key.
+    */
+    SortedChildRange childrenInRange(StringView first, StringView last) const;
+
+    /**
+      \returns handles to the direct children which are sections and have keys
+               starting with the given prefix, ordered by key.
+    */
+    SortedSectionRange sectionsWithPrefix(StringView prefix) const;
+
     bool hasValue() const;
     bool hasValue(Path const & path) const;
     bool hasSection() const;
@@ -258,8 +1098,193 @@ public: /* Methods: */
     auto get(Path const & path_, DefaultValueType<T> defaultValue) const
             -> typename std::enable_if<isReadableValueType<T>, T>::type;
 
+    /**
+      \brief Like value(), but reports failures via the result instead of
+             throwing exceptions.
+    */
+    template <typename T>
+    auto tryValue() const noexcept
+            -> typename std::enable_if<isReadableValueType<T>,
+                                       GetResult<T> >::type;
+
+    /**
+      \brief Like get(), but reports failures via the result instead of
+             throwing exceptions. Lookups of missing values neither allocate
+             memory nor throw.
+    */
+    template <typename T>
+    auto tryGet(Path const & path_) const noexcept
+            -> typename std::enable_if<isReadableValueType<T>,
+                                       GetResult<T> >::type;
+
+    /**
+      \brief Like value<std::string>(), but returns a view of the stored value
+             instead of a copy.
+
+      Values subject to interpolation are interpolated on every call, but the
+      latest result is stored with the value and the returned view refers to
+      the stored copy.
+
+      \warning The returned view remains valid only until the value is erased
+               or all Configuration objects sharing the loaded configuration
+               are destroyed. Views of values subject to interpolation are also
+               invalidated when the value is next read after modifying the
+               interpolation, e.g. by resetTime() or addVariable().
+    */
+    StringView valueView() const;
+
+    /**
+      \brief Like get<std::string>(path), but returns a view of the stored
+             value instead of a copy, see valueView().
+    */
+    StringView getView(Path const & path_) const;
+
+    /**
+      \brief Like get<std::string>(path, defaultValue), but returns a view of
+             the stored value instead of a copy, see valueView().
+      \returns defaultValue if no value is found.
+    */
+    StringView getView(Path const & path_, StringView defaultValue) const;
+
     Configuration section(Path const & path) const;
 
+    /** \returns a lightweight non-owning view of this configuration. */
+    View view() const noexcept;
+
+    /**
+      \brief Creates a request for getMany() to read the value at the given
+             path into the given output variable.
+    */
+    template <typename T>
+    static auto getRequest(Path path, T & out)
+            -> typename std::enable_if<isReadableValueType<T>,
+                                       GetRequest>::type
+    { return GetRequest(std::move(path), &out, &readInto<T>, false); }
+
+    /**
+      \brief Creates a request for getMany() to read the value at the given
+             path into the given output variable, which is immediately
+             assigned the given default value to be kept if no value is found.
+    */
+    template <typename T>
+    static auto getRequest(Path path,
+                           T & out,
+                           DefaultValueType<T> defaultValue)
+            -> typename std::enable_if<isReadableValueType<T>,
+                                       GetRequest>::type
+    {
+        assignDefault(out, std::move(defaultValue));
+        return GetRequest(std::move(path), &out, &readInto<T>, true);
+    }
+
+    /**
+      \brief Reads multiple values in a single traversal of the configuration.
+
+      The requests are processed in the lexicographic order of their paths so
+      that common path prefixes are looked up only once.
+
+      \throws GetManyException listing all requests which failed, i.e. those
+              for which reading or parsing the value failed, and those without
+              a default value for which no value was found.
+    */
+    void getMany(std::vector<GetRequest> const & requests) const;
+
+    /**
+      \brief Creates a rule for validate() requiring all values matching the
+             given pattern, see query(), to be readable as type T.
+      \param[in] required whether the pattern must match at least one node.
+    */
+    template <typename T>
+    static auto validationRule(Path pattern, bool required = true)
+            -> typename std::enable_if<isReadableValueType<T>,
+                                       ValidationRule>::type
+    {
+        return ValidationRule(std::move(pattern),
+                              &validateValue<T>,
+                              nullptr,
+                              required);
+    }
+
+    /**
+      \brief Like validationRule<T>(pattern, required), but also requires the
+             read values to satisfy the given predicate.
+    */
+    template <typename T>
+    static auto validationRule(Path pattern,
+                               std::function<bool (T const &)> check,
+                               bool required = true)
+            -> typename std::enable_if<isReadableValueType<T>,
+                                       ValidationRule>::type
+    {
+        using Check = std::function<bool (T const &)>;
+        return ValidationRule(std::move(pattern),
+                              &validateValue<T>,
+                              std::make_shared<Check const>(std::move(check)),
+                              required);
+    }
+
+    /**
+      \brief Like validationRule<T>(pattern, required), but also requires the
+             read values to be within the given closed range.
+    */
+    template <typename T>
+    static auto rangeValidationRule(Path pattern,
+                                    T min,
+                                    T max,
+                                    bool required = true)
+            -> typename std::enable_if<isReadableValueType<T>,
+                                       ValidationRule>::type
+    {
+        return validationRule<T>(
+                    std::move(pattern),
+                    [min, max](T const & value)
+                    { return !(value < min) && !(max < value); },
+                    required);
+    }
+
+    /**
+      \brief Checks in parallel that all values matching the given rules are
+             present, can be interpolated and parsed, and satisfy the checks
+             of the rules.
+
+      The values are divided between the calling thread and up to
+      parallelism - 1 tasks run by the given executor. The parsed values are
+      cached for the subsequent reads of the values if parsed value caching is
+      enabled, see setParsedValueCaching(). Values requiring interpolation are
+      checked but not cached, because their interpolated value may change.
+
+      \throws ValidationException listing all values which failed validation,
+              along with the files and lines they were loaded from.
+    */
+    void validate(std::vector<ValidationRule> const & rules,
+                  Executor const & executor,
+                  std::size_t parallelism) const;
+
+    /**
+      \brief Like validate(rules, executor, parallelism), but runs the tasks in
+             new threads, one per hardware thread.
+    */
+    void validate(std::vector<ValidationRule> const & rules) const;
+
+    /**
+      \brief Finds all nodes below this configuration matching the given
+             pattern.
+
+      Every component of the pattern is matched against the key at the
+      respective level, where "*" matches any sequence of characters and "?"
+      matches any single character. A component consisting only of "**"
+      matches zero or more levels. For example, "Peer*.Port" matches the Port
+      keys of all sections whose names start with "Peer", and "**.Enabled"
+      matches all Enabled keys at any depth. The pattern is evaluated during a
+      single traversal which uses the sorted index of keys for components
+      starting with a literal prefix.
+
+      \returns the matches in depth-first order, without duplicates. Keys
+               matched by components starting with a literal prefix are
+               visited in key order, other keys in the order of declaration.
+    */
+    std::vector<Match> query(Path const & pattern) const;
+
     void clear() noexcept;
 
     void erase() noexcept;
@@ -277,6 +1302,23 @@ public: /* Methods: */
 
 private: /* Methods: */
 
+    template <typename T>
+    static void readInto(void * out,
+                         ptree const & node,
+                         Configuration const & owner);
+
+    template <typename T>
+    static void validateValue(ptree const & node,
+                              Configuration const & owner,
+                              void const * check);
+
+    static void assignDefault(std::string & out, StringView defaultValue)
+    { out.assign(defaultValue.data(), defaultValue.size()); }
+
+    template <typename T>
+    static void assignDefault(T & out, T defaultValue)
+    { out = std::move(defaultValue); }
+
     Configuration(std::shared_ptr<Path const> path,
                   std::shared_ptr<Inner> inner,
                   ptree & ptree) noexcept;
@@ -292,21 +1334,34 @@ private: /* Fields: */
 #define SHAREMIND_LIBCONFIGURATION_CONFIGURATION_H_(T) \
     extern template T Configuration::value<T>() const; \
     extern template T Configuration::get<T>(Path const &) const; \
-    extern template T Configuration::get<T>(Path const &, DefaultValueType<T>) const
-SHAREMIND_LIBCONFIGURATION_CONFIGURATION_H_(std::string);
-SHAREMIND_LIBCONFIGURATION_CONFIGURATION_H_(std::int8_t);
-SHAREMIND_LIBCONFIGURATION_CONFIGURATION_H_(std::int16_t);
-SHAREMIND_LIBCONFIGURATION_CONFIGURATION_H_(std::int32_t);
-SHAREMIND_LIBCONFIGURATION_CONFIGURATION_H_(std::int64_t);
-SHAREMIND_LIBCONFIGURATION_CONFIGURATION_H_(std::uint8_t);
-SHAREMIND_LIBCONFIGURATION_CONFIGURATION_H_(std::uint16_t);
-SHAREMIND_LIBCONFIGURATION_CONFIGURATION_H_(std::uint32_t);
-SHAREMIND_LIBCONFIGURATION_CONFIGURATION_H_(std::uint64_t);
-SHAREMIND_LIBCONFIGURATION_CONFIGURATION_H_(float);
-SHAREMIND_LIBCONFIGURATION_CONFIGURATION_H_(double);
-SHAREMIND_LIBCONFIGURATION_CONFIGURATION_H_(long double);
+    extern template T Configuration::get<T>(Path const &, DefaultValueType<T>) const; \
+    extern template Configuration::GetResult<T> \
+    Configuration::tryValue<T>() const noexcept; \
+    extern template Configuration::GetResult<T> \
+    Configuration::tryGet<T>(Path const &) const noexcept; \
+    extern template T Configuration::View::value<T>() const; \
+    extern template T Configuration::View::get<T>(Path const &) const; \
+    extern template T Configuration::View::get<T>(Path const &, \
+                                                  DefaultValueType<T>) const; \
+    extern template Configuration::GetResult<T> \
+    Configuration::View::tryValue<T>() const noexcept; \
+    extern template Configuration::GetResult<T> \
+    Configuration::View::tryGet<T>(Path const &) const noexcept; \
+    extern template void Configuration::readInto<T>(void *, \
+                                                    ptree const &, \
+                                                    Configuration const &); \
+    extern template void Configuration::validateValue<T>( \
+            ptree const &, \
+            Configuration const &, \
+            void const *);
+SHAREMIND_LIBCONFIGURATION_FOR_EACH_VALUE_TYPE(
+        SHAREMIND_LIBCONFIGURATION_CONFIGURATION_H_)
 #undef SHAREMIND_LIBCONFIGURATION_CONFIGURATION_H_
 
+using ConfigurationView = Configuration::View;
+
+static_assert(std::is_trivially_copyable<ConfigurationView>::value, "");
+
 } /* namespace sharemind { */
 
 #endif /* SHAREMIND_LIBCONFIGURATION_CONFIGURATION_H */
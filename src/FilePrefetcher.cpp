@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2017 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+
+#include "FilePrefetcher_p.h"
+
+#include <fcntl.h>
+#include <iterator>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utility>
+
+
+namespace sharemind {
+
+FilePrefetcher::FilePrefetcher() noexcept {}
+
+FilePrefetcher::~FilePrefetcher() noexcept {
+    {
+        std::lock_guard<std::mutex> const guard(m_mutex);
+        m_stop = true;
+        m_queue.clear();
+    }
+    m_condition.notify_one();
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+void FilePrefetcher::prefetch(std::vector<std::string> paths) noexcept {
+    try {
+        {
+            std::lock_guard<std::mutex> const guard(m_mutex);
+            if (m_threadFailed)
+                return;
+            m_queue.insert(m_queue.begin(),
+                           std::make_move_iterator(paths.begin()),
+                           std::make_move_iterator(paths.end()));
+        }
+        startOrNotify();
+    } catch (...) {}
+}
+
+void FilePrefetcher::startOrNotify() noexcept {
+    if (m_thread.joinable()) {
+        m_condition.notify_one();
+        return;
+    }
+    try {
+        m_thread = std::thread(&FilePrefetcher::run, this);
+    } catch (...) {
+        std::lock_guard<std::mutex> const guard(m_mutex);
+        m_threadFailed = true;
+        m_queue.clear();
+    }
+}
+
+void FilePrefetcher::run() noexcept {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        m_condition.wait(lock, [this]() noexcept
+                               { return m_stop || !m_queue.empty(); });
+        if (m_stop)
+            return;
+        auto const path(std::move(m_queue.front()));
+        m_queue.pop_front();
+        lock.unlock();
+        prefetchFile(path);
+        lock.lock();
+    }
+}
+
+void FilePrefetcher::prefetchFile(std::string const & path) noexcept {
+    auto const fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC | O_NOCTTY);
+    if (fd < 0)
+        return;
+    struct ::stat fileStat;
+    if (!::fstat(fd, &fileStat)
+        && S_ISREG(fileStat.st_mode)
+        && fileStat.st_size > 0)
+    {
+        /* Hint the kernel to start reading asynchronously, then block this
+           thread until the data is actually in the page cache, which on
+           network file systems may take a while: */
+        ::posix_fadvise(fd, 0, fileStat.st_size, POSIX_FADV_WILLNEED);
+        ::readahead(fd, 0, static_cast<std::size_t>(fileStat.st_size));
+    }
+    ::close(fd);
+}
+
+} /* namespace sharemind { */
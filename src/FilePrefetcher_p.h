@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2017 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+
+#ifndef SHAREMIND_LIBCONFIGURATION_FILEPREFETCHER_P_H
+#define SHAREMIND_LIBCONFIGURATION_FILEPREFETCHER_P_H
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <sharemind/visibility.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace sharemind {
+
+/**
+  \brief Warms the page cache for files which are about to be read, by opening
+         and reading them ahead on a background thread.
+
+  Prefetching is best effort only: failures to start the thread, to open or to
+  read files are ignored, since the files will be opened and read again by the
+  actual reader, which then reports any errors.
+*/
+class SHAREMIND_VISIBILITY_INTERNAL FilePrefetcher {
+
+public: /* Methods: */
+
+    FilePrefetcher() noexcept;
+    FilePrefetcher(FilePrefetcher &&) = delete;
+    FilePrefetcher(FilePrefetcher const &) = delete;
+
+    /** \brief Discards all pending files and waits for the thread to stop. */
+    ~FilePrefetcher() noexcept;
+
+    FilePrefetcher & operator=(FilePrefetcher &&) = delete;
+    FilePrefetcher & operator=(FilePrefetcher const &) = delete;
+
+    /**
+      \brief Queues the given files to be prefetched in order, ahead of any
+             files queued earlier which have not yet been prefetched.
+    */
+    void prefetch(std::vector<std::string> paths) noexcept;
+
+private: /* Methods: */
+
+    void startOrNotify() noexcept;
+    void run() noexcept;
+
+    static void prefetchFile(std::string const & path) noexcept;
+
+private: /* Fields: */
+
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::deque<std::string> m_queue;
+    bool m_stop = false;
+    bool m_threadFailed = false;
+    std::thread m_thread;
+
+}; /* class FilePrefetcher */
+
+} /* namespace sharemind { */
+
+#endif /* SHAREMIND_LIBCONFIGURATION_FILEPREFETCHER_P_H */
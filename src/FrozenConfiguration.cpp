@@ -0,0 +1,594 @@
+/*
+ * Copyright (C) 2017 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#include "FrozenConfiguration.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <fcntl.h>
+#include <limits>
+#include <new>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <system_error>
+#include <unistd.h>
+#include <vector>
+#include "ValueHandler_p.h"
+
+
+namespace sharemind {
+
+namespace {
+
+struct ImageHeader {
+    char magic[8];
+    std::uint32_t imageSize;
+    std::uint32_t numNodes;
+};
+
+constexpr char const imageMagic[8] = {'S','M','C','O','N','F','1','\0'};
+
+constexpr std::uint32_t const hasValueFlag = 1u;
+constexpr std::uint32_t const hasSectionFlag = 2u;
+
+[[noreturn]] inline void throwErrno()
+{ throw std::system_error(errno, std::system_category()); }
+
+/** \returns whether the image is well-formed and all its offsets are within
+             bounds, i.e. whether it is safe to read. */
+template <typename Node>
+bool validateImage(char const * const image, std::size_t const size) noexcept {
+    if (size < sizeof(ImageHeader))
+        return false;
+    ImageHeader header;
+    std::memcpy(&header, image, sizeof(header));
+    if (std::memcmp(header.magic, imageMagic, sizeof(imageMagic)) != 0)
+        return false;
+    std::uint64_t const imageSize = header.imageSize;
+    if ((imageSize > size) || !header.numNodes)
+        return false;
+    std::uint64_t const nodesOffset = sizeof(ImageHeader);
+    std::uint64_t const nodesEnd =
+            nodesOffset + std::uint64_t(header.numNodes) * sizeof(Node);
+    if (nodesEnd > imageSize)
+        return false;
+
+    auto const inImage =
+            [imageSize](std::uint64_t const offset, std::uint64_t const n) {
+                return (offset <= imageSize) && (n <= imageSize - offset);
+            };
+    for (std::uint64_t nodeOffset = nodesOffset;
+         nodeOffset < nodesEnd;
+         nodeOffset += sizeof(Node))
+    {
+        auto const & node =
+                *reinterpret_cast<Node const *>(image + nodeOffset);
+        if ((node.flags & ~(hasValueFlag | hasSectionFlag))
+            || !inImage(node.keyOffset, node.keySize)
+            || !inImage(node.valueOffset, node.valueSize)
+            || (node.firstChild < nodesOffset)
+            || ((node.firstChild - nodesOffset) % sizeof(Node))
+            || (node.sortedChildren % alignof(std::uint32_t)))
+            return false;
+        std::uint64_t const numChildren = node.numChildren;
+        std::uint64_t const childrenEnd =
+                node.firstChild + numChildren * sizeof(Node);
+        if ((childrenEnd > nodesEnd)
+            || !inImage(node.sortedChildren,
+                        numChildren * sizeof(std::uint32_t)))
+            return false;
+        if (!numChildren)
+            continue;
+        // Children must follow their parent, which rules out cycles:
+        if (node.firstChild <= nodeOffset)
+            return false;
+        auto const * const sorted =
+                reinterpret_cast<std::uint32_t const *>(
+                    image + node.sortedChildren);
+        for (std::uint64_t i = 0u; i < numChildren; ++i)
+            if ((sorted[i] < node.firstChild)
+                || (sorted[i] >= childrenEnd)
+                || ((sorted[i] - node.firstChild) % sizeof(Node)))
+                return false;
+    }
+    return true;
+}
+
+inline int compareKeys(StringView const a, StringView const b) noexcept {
+    auto const minSize = std::min(a.size(), b.size());
+    if (minSize)
+        if (auto const r = std::memcmp(a.data(), b.data(), minSize))
+            return r;
+    return (a.size() < b.size()) ? -1 : (a.size() > b.size()) ? 1 : 0;
+}
+
+template <typename T>
+bool tryParseFrozenValue(StringView const value, T & out)
+{ return ValueHandler<T>::tryParse(value, out); }
+
+template <typename T>
+FrozenConfiguration::GetResult<T> tryParseFrozenValue(StringView const value)
+        noexcept
+{
+    using GetError = FrozenConfiguration::GetError;
+    try {
+        T r;
+        if (tryParseFrozenValue(value, r))
+            return FrozenConfiguration::GetResult<T>(std::move(r));
+        return GetError::ParseFailed;
+    } catch (std::bad_alloc const &) {
+        return GetError::OutOfMemory;
+    } catch (...) {
+        return GetError::ParseFailed;
+    }
+}
+
+template <typename T>
+T parseFrozenValue(StringView const value) {
+    try {
+        T r;
+        if (tryParseFrozenValue(value, r))
+            return r;
+        throw Configuration::FailedToParseValueException();
+    } catch (...) {
+        std::throw_with_nested(Configuration::FailedToParseValueException());
+    }
+}
+
+} // anonymous namespace
+
+SHAREMIND_DEFINE_EXCEPTION_NOINLINE(Configuration::Exception,
+                                    FrozenConfiguration::,
+                                    Exception);
+SHAREMIND_DEFINE_EXCEPTION_CONST_MSG_NOINLINE(
+        Exception,
+        FrozenConfiguration::,
+        TooLargeException,
+        "Configuration too large to freeze!");
+SHAREMIND_DEFINE_EXCEPTION_CONST_MSG_NOINLINE(
+        Exception,
+        FrozenConfiguration::,
+        MapException,
+        "Failed to map memory for frozen configuration!");
+SHAREMIND_DEFINE_EXCEPTION_CONST_MSG_NOINLINE(
+        Exception,
+        FrozenConfiguration::,
+        InvalidImageException,
+        "Invalid frozen configuration image!");
+
+StringView FrozenConfiguration::View::key() const noexcept
+{ return StringView(m_image + m_node->keyOffset, m_node->keySize); }
+
+bool FrozenConfiguration::View::empty() const noexcept
+{ return !m_node->numChildren; }
+
+FrozenConfiguration::SizeType FrozenConfiguration::View::size() const noexcept
+{ return m_node->numChildren; }
+
+FrozenConfiguration::View::Iterator FrozenConfiguration::View::begin()
+        const noexcept
+{
+    return Iterator(m_image,
+                    reinterpret_cast<Node const *>(
+                        m_image + m_node->firstChild));
+}
+
+FrozenConfiguration::View::Iterator FrozenConfiguration::View::end()
+        const noexcept
+{ return begin() + static_cast<std::ptrdiff_t>(m_node->numChildren); }
+
+bool FrozenConfiguration::View::hasValue() const noexcept
+{ return m_node->flags & hasValueFlag; }
+
+bool FrozenConfiguration::View::hasValue(Path const & path) const noexcept {
+    auto const * const node = findChild(path);
+    return node && (node->flags & hasValueFlag);
+}
+
+bool FrozenConfiguration::View::hasSection() const noexcept
+{ return m_node->flags & hasSectionFlag; }
+
+bool FrozenConfiguration::View::hasSection(Path const & path) const noexcept {
+    auto const * const node = findChild(path);
+    return node && (node->flags & hasSectionFlag);
+}
+
+template <typename T>
+auto FrozenConfiguration::View::value() const
+        -> typename std::enable_if<Configuration::isReadableValueType<T>,
+                                   T>::type
+{ return parseFrozenValue<T>(valueView()); }
+
+template <typename T>
+auto FrozenConfiguration::View::get(Path const & path_) const
+        -> typename std::enable_if<Configuration::isReadableValueType<T>,
+                                   T>::type
+{ return parseFrozenValue<T>(getView(path_)); }
+
+template <typename T>
+auto FrozenConfiguration::View::get(Path const & path_,
+                                    DefaultValueType<T> defaultValue) const
+        -> typename std::enable_if<Configuration::isReadableValueType<T>,
+                                   T>::type
+{
+    auto const * const node = findChild(path_);
+    if (!node || !(node->flags & hasValueFlag))
+        return ValueHandler<T>::generateDefault(std::move(defaultValue));
+    return parseFrozenValue<T>(View(m_image, *node).valueView());
+}
+
+template <typename T>
+auto FrozenConfiguration::View::tryValue() const noexcept
+        -> typename std::enable_if<Configuration::isReadableValueType<T>,
+                                   GetResult<T> >::type
+{
+    if (!hasValue())
+        return GetError::ValueNotFound;
+    return tryParseFrozenValue<T>(
+                StringView(m_image + m_node->valueOffset, m_node->valueSize));
+}
+
+template <typename T>
+auto FrozenConfiguration::View::tryGet(Path const & path_) const noexcept
+        -> typename std::enable_if<Configuration::isReadableValueType<T>,
+                                   GetResult<T> >::type
+{
+    if (auto const * const node = findChild(path_))
+        return View(m_image, *node).tryValue<T>();
+    return GetError::ValueNotFound;
+}
+
+StringView FrozenConfiguration::View::valueView() const {
+    if (!hasValue())
+        throw Configuration::ValueNotFoundException();
+    return StringView(m_image + m_node->valueOffset, m_node->valueSize);
+}
+
+StringView FrozenConfiguration::View::getView(Path const & path_) const {
+    if (auto const * const node = findChild(path_))
+        return View(m_image, *node).valueView();
+    throw Configuration::ValueNotFoundException();
+}
+
+StringView FrozenConfiguration::View::getView(Path const & path_,
+                                              StringView defaultValue)
+        const noexcept
+{
+    auto const * const node = findChild(path_);
+    if (!node || !(node->flags & hasValueFlag))
+        return defaultValue;
+    return StringView(m_image + node->valueOffset, node->valueSize);
+}
+
+FrozenConfiguration::View FrozenConfiguration::View::section(
+        Path const & path) const
+{
+    auto const * const node = findChild(path);
+    if (!node || !(node->flags & hasSectionFlag))
+        throw Configuration::SectionNotFoundException();
+    return View(m_image, *node);
+}
+
+FrozenConfiguration::Node const * FrozenConfiguration::View::findChild(
+        Path const & path) const noexcept
+{
+    auto const * node = m_node;
+    for (auto const & component : path.components()) {
+        auto const * const sorted =
+                reinterpret_cast<std::uint32_t const *>(
+                    m_image + node->sortedChildren);
+        auto const * const sortedEnd = sorted + node->numChildren;
+        auto const it =
+                std::lower_bound(
+                    sorted,
+                    sortedEnd,
+                    StringView(component),
+                    [this](std::uint32_t const offset, StringView const key) {
+                        auto const & child =
+                                *reinterpret_cast<Node const *>(
+                                    m_image + offset);
+                        return compareKeys(
+                                    StringView(m_image + child.keyOffset,
+                                               child.keySize),
+                                    key) < 0;
+                    });
+        if (it == sortedEnd)
+            return nullptr;
+        node = reinterpret_cast<Node const *>(m_image + *it);
+        if (compareKeys(StringView(m_image + node->keyOffset, node->keySize),
+                        component) != 0)
+            return nullptr;
+    }
+    return node;
+}
+
+FrozenConfiguration::FrozenConfiguration(Configuration const & configuration)
+{
+    /* Lay out the nodes in breadth-first order so that the children of every
+       node are contiguous. Offsets are first relative to the respective
+       arrays and are rebased once the sizes of the arrays are known: */
+    std::vector<Configuration::View> views;
+    std::vector<Node> nodes;
+    std::vector<std::uint32_t> sorted;
+    std::string strings;
+
+    auto const toU32 =
+            [](std::size_t const v) {
+                if (v > std::numeric_limits<std::uint32_t>::max())
+                    throw TooLargeException();
+                return static_cast<std::uint32_t>(v);
+            };
+    auto const addNode =
+            [&views, &nodes, &strings, &toU32](Configuration::View const & v) {
+                Node node{};
+                auto const & key = v.key();
+                node.keyOffset = toU32(strings.size());
+                node.keySize = toU32(key.size());
+                strings.append(key);
+                if (v.hasValue()) {
+                    auto const value(v.valueView());
+                    node.valueOffset = toU32(strings.size());
+                    node.valueSize = toU32(value.size());
+                    strings.append(value.data(), value.size());
+                    node.flags |= hasValueFlag;
+                }
+                if (v.hasSection())
+                    node.flags |= hasSectionFlag;
+                views.emplace_back(v);
+                nodes.emplace_back(node);
+            };
+
+    addNode(configuration.view());
+    for (std::size_t i = 0u; i < views.size(); ++i) {
+        auto const firstChild = views.size();
+        for (auto const child : views[i])
+            addNode(child);
+        auto const numChildren = views.size() - firstChild;
+        nodes[i].firstChild = toU32(firstChild);
+        nodes[i].numChildren = toU32(numChildren);
+        nodes[i].sortedChildren = toU32(sorted.size());
+        for (std::size_t j = firstChild; j < views.size(); ++j)
+            sorted.emplace_back(toU32(j));
+        std::sort(sorted.end() - static_cast<std::ptrdiff_t>(numChildren),
+                  sorted.end(),
+                  [&nodes, &strings](std::uint32_t const a,
+                                     std::uint32_t const b)
+                  {
+                      return compareKeys(
+                                  StringView(
+                                      strings.data() + nodes[a].keyOffset,
+                                      nodes[a].keySize),
+                                  StringView(
+                                      strings.data() + nodes[b].keyOffset,
+                                      nodes[b].keySize)) < 0;
+                  });
+    }
+    views.clear();
+
+    static_assert(sizeof(ImageHeader) % alignof(Node) == 0u, "");
+    static_assert(sizeof(Node) % alignof(std::uint32_t) == 0u, "");
+    std::size_t const nodesOffset = sizeof(ImageHeader);
+    std::size_t const sortedOffset = nodesOffset + nodes.size() * sizeof(Node);
+    std::size_t const stringsOffset =
+            sortedOffset + sorted.size() * sizeof(std::uint32_t);
+    auto const imageSize = toU32(stringsOffset + strings.size());
+    for (auto & node : nodes) {
+        node.keyOffset = toU32(node.keyOffset + stringsOffset);
+        node.valueOffset = toU32(node.valueOffset + stringsOffset);
+        node.firstChild = toU32(nodesOffset + node.firstChild * sizeof(Node));
+        node.sortedChildren =
+                toU32(sortedOffset
+                      + node.sortedChildren * sizeof(std::uint32_t));
+    }
+    for (auto & offset : sorted)
+        offset = toU32(nodesOffset + offset * sizeof(Node));
+
+    auto const pageSize = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    auto const mappingSize = (imageSize + pageSize - 1u) / pageSize * pageSize;
+    auto * const image = ::mmap(nullptr,
+                                mappingSize,
+                                PROT_READ | PROT_WRITE,
+                                MAP_PRIVATE | MAP_ANONYMOUS,
+                                -1,
+                                0);
+    if (image == MAP_FAILED)
+        throw MapException();
+    m_image = static_cast<char *>(image);
+    m_mappingSize = mappingSize;
+
+    ImageHeader header;
+    std::memcpy(header.magic, imageMagic, sizeof(imageMagic));
+    header.imageSize = imageSize;
+    header.numNodes = toU32(nodes.size());
+    std::memcpy(m_image, &header, sizeof(header));
+    std::memcpy(m_image + nodesOffset,
+                nodes.data(),
+                nodes.size() * sizeof(Node));
+    if (!sorted.empty())
+        std::memcpy(m_image + sortedOffset,
+                    sorted.data(),
+                    sorted.size() * sizeof(std::uint32_t));
+    if (!strings.empty())
+        std::memcpy(m_image + stringsOffset, strings.data(), strings.size());
+
+    if (::mprotect(m_image, m_mappingSize, PROT_READ) != 0) {
+        reset();
+        throw MapException();
+    }
+}
+
+FrozenConfiguration::FrozenConfiguration(FrozenConfiguration && move) noexcept
+    : m_image(move.m_image)
+    , m_mappingSize(move.m_mappingSize)
+{
+    move.m_image = nullptr;
+    move.m_mappingSize = 0u;
+}
+
+FrozenConfiguration::~FrozenConfiguration() noexcept { reset(); }
+
+FrozenConfiguration & FrozenConfiguration::operator=(
+        FrozenConfiguration && move) noexcept
+{
+    if (this != &move) {
+        reset();
+        m_image = move.m_image;
+        m_mappingSize = move.m_mappingSize;
+        move.m_image = nullptr;
+        move.m_mappingSize = 0u;
+    }
+    return *this;
+}
+
+FrozenConfiguration::View FrozenConfiguration::view() const noexcept {
+    assert(m_image);
+    return View(m_image,
+                *reinterpret_cast<Node const *>(m_image + sizeof(ImageHeader)));
+}
+
+std::size_t FrozenConfiguration::imageSize() const noexcept {
+    if (!m_image)
+        return 0u;
+    return reinterpret_cast<ImageHeader const *>(m_image)->imageSize;
+}
+
+void FrozenConfiguration::writeImage(int const fd) const {
+    auto const * data = m_image;
+    for (auto left = imageSize(); left;) {
+        auto const r = ::write(fd, data, left);
+        if (r < 0) {
+            if (errno == EINTR)
+                continue;
+            throwErrno();
+        }
+        data += r;
+        left -= static_cast<std::size_t>(r);
+    }
+}
+
+int FrozenConfiguration::createMemfd(char const * const name) const {
+    /* Use the system call directly, as the glibc wrapper was introduced only
+       in glibc 2.27: */
+    auto const fd = static_cast<int>(
+                ::syscall(SYS_memfd_create,
+                          name,
+                          MFD_CLOEXEC | MFD_ALLOW_SEALING));
+    if (fd < 0)
+        throwErrno();
+    try {
+        writeImage(fd);
+        if (::fcntl(fd,
+                    F_ADD_SEALS,
+                    F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL)
+            != 0)
+            throwErrno();
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+    return fd;
+}
+
+FrozenConfiguration FrozenConfiguration::mapImage(int const fd) {
+    /* Only images which can not be modified after validation are mapped in
+       place, others are copied: */
+    constexpr int const requiredSeals =
+            F_SEAL_WRITE | F_SEAL_SHRINK | F_SEAL_GROW;
+    auto const seals = ::fcntl(fd, F_GET_SEALS);
+    bool const sealed =
+            (seals >= 0) && ((seals & requiredSeals) == requiredSeals);
+
+    struct ::stat st;
+    if (::fstat(fd, &st) != 0)
+        throwErrno();
+    if ((st.st_size < static_cast<::off_t>(sizeof(ImageHeader)))
+        || (static_cast<std::uintmax_t>(st.st_size)
+            > std::numeric_limits<std::size_t>::max()))
+        throw InvalidImageException();
+    auto const size = static_cast<std::size_t>(st.st_size);
+    if (sealed) {
+        auto * const image =
+                ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        if (image == MAP_FAILED)
+            throw MapException();
+        FrozenConfiguration r(static_cast<char *>(image), size);
+        if (!validateImage<Node>(r.m_image, size))
+            throw InvalidImageException();
+        return r;
+    }
+
+    auto const pageSize = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    if (size > std::numeric_limits<std::size_t>::max() - pageSize)
+        throw InvalidImageException();
+    auto const mappingSize = (size + pageSize - 1u) / pageSize * pageSize;
+    auto * const image = ::mmap(nullptr,
+                                mappingSize,
+                                PROT_READ | PROT_WRITE,
+                                MAP_PRIVATE | MAP_ANONYMOUS,
+                                -1,
+                                0);
+    if (image == MAP_FAILED)
+        throw MapException();
+    FrozenConfiguration r(static_cast<char *>(image), mappingSize);
+    for (std::size_t done = 0u; done < size;) {
+        auto const n = ::pread(fd,
+                               r.m_image + done,
+                               size - done,
+                               static_cast<::off_t>(done));
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            throwErrno();
+        }
+        if (!n) // Truncated in the meantime
+            throw InvalidImageException();
+        done += static_cast<std::size_t>(n);
+    }
+    if (::mprotect(r.m_image, mappingSize, PROT_READ) != 0)
+        throw MapException();
+    if (!validateImage<Node>(r.m_image, size))
+        throw InvalidImageException();
+    return r;
+}
+
+void FrozenConfiguration::reset() noexcept {
+    if (m_image) {
+        ::munmap(m_image, m_mappingSize);
+        m_image = nullptr;
+        m_mappingSize = 0u;
+    }
+}
+
+#define DEFINE_GETTERS(T) \
+    template T FrozenConfiguration::View::value<T>() const; \
+    template T FrozenConfiguration::View::get<T>(Path const &) const; \
+    template T FrozenConfiguration::View::get<T>(Path const &, \
+                                                 DefaultValueType<T>) const; \
+    template FrozenConfiguration::GetResult<T> \
+    FrozenConfiguration::View::tryValue<T>() const noexcept; \
+    template FrozenConfiguration::GetResult<T> \
+    FrozenConfiguration::View::tryGet<T>(Path const &) const noexcept;
+SHAREMIND_LIBCONFIGURATION_FOR_EACH_VALUE_TYPE(DEFINE_GETTERS)
+#undef DEFINE_GETTERS
+
+} /* namespace sharemind { */
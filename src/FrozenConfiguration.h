@@ -0,0 +1,335 @@
+/*
+ * Copyright (C) 2017 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#ifndef SHAREMIND_LIBCONFIGURATION_FROZENCONFIGURATION_H
+#define SHAREMIND_LIBCONFIGURATION_FROZENCONFIGURATION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <sharemind/StringView.h>
+#include <string>
+#include <type_traits>
+#include "Configuration.h"
+#include "Path.h"
+
+
+namespace sharemind {
+
+/**
+  \brief An immutable snapshot of a loaded configuration, stored in a single
+         dedicated, page-aligned and read-only memory region.
+
+  The snapshot contains no pointers, reference counts or caches, and reading
+  it performs no writes to the region. This makes it suitable for processes
+  which load their configuration and then fork workers: reads in the children
+  never touch the shared pages, hence never cause them to be copied.
+
+  Values are interpolated when the snapshot is created, using the
+  interpolation of the source configuration (if any), and stored as strings.
+  Values are parsed on every read.
+
+  The image is relocatable, i.e. it contains only offsets relative to its
+  beginning. It can be exported with createMemfd() or writeImage(), and mapped
+  by other processes on the same host with mapImage(), letting them share a
+  single physical copy of the configuration without parsing it.
+*/
+class FrozenConfiguration {
+
+private: /* Types: */
+
+    /*
+      A node of the image. All offsets are in bytes from the beginning of the
+      image. The children of every node are stored contiguously in file order,
+      and are additionally indexed by an array of offsets sorted by key.
+    */
+    struct Node {
+        std::uint32_t keyOffset;
+        std::uint32_t keySize;
+        std::uint32_t valueOffset;
+        std::uint32_t valueSize;
+        std::uint32_t firstChild;
+        std::uint32_t numChildren;
+        std::uint32_t sortedChildren;
+        std::uint32_t flags;
+    };
+
+public: /* Types: */
+
+    template <typename T>
+    using DefaultValueType = Configuration::DefaultValueType<T>;
+
+    template <typename T>
+    using GetResult = Configuration::GetResult<T>;
+
+    using GetError = Configuration::GetError;
+    using SizeType = std::size_t;
+
+    SHAREMIND_DECLARE_EXCEPTION_NOINLINE(Configuration::Exception, Exception);
+    SHAREMIND_DECLARE_EXCEPTION_CONST_MSG_NOINLINE(Exception,
+                                                   TooLargeException);
+    SHAREMIND_DECLARE_EXCEPTION_CONST_MSG_NOINLINE(Exception,
+                                                   MapException);
+    SHAREMIND_DECLARE_EXCEPTION_CONST_MSG_NOINLINE(Exception,
+                                                   InvalidImageException);
+
+    /**
+      \brief A trivially copyable view of a node in a FrozenConfiguration.
+      \warning Views are only valid as long as the FrozenConfiguration object
+               they were obtained from is alive.
+    */
+    class View {
+
+        friend class FrozenConfiguration;
+
+    public: /* Types: */
+
+        class Iterator {
+
+            friend class View;
+
+        public: /* Types: */
+
+            using iterator_category = std::random_access_iterator_tag;
+            using value_type = View;
+            using difference_type = std::ptrdiff_t;
+            using pointer = View const *;
+            using reference = View;
+
+        public: /* Methods: */
+
+            View operator*() const noexcept { return View(m_image, *m_node); }
+
+            Iterator & operator++() noexcept { ++m_node; return *this; }
+            Iterator operator++(int) noexcept
+            { auto r(*this); ++m_node; return r; }
+            Iterator & operator--() noexcept { --m_node; return *this; }
+            Iterator operator--(int) noexcept
+            { auto r(*this); --m_node; return r; }
+
+            Iterator & operator+=(difference_type n) noexcept
+            { m_node += n; return *this; }
+            Iterator & operator-=(difference_type n) noexcept
+            { m_node -= n; return *this; }
+            Iterator operator+(difference_type n) const noexcept
+            { return Iterator(m_image, m_node + n); }
+            Iterator operator-(difference_type n) const noexcept
+            { return Iterator(m_image, m_node - n); }
+            difference_type operator-(Iterator const & rhs) const noexcept
+            { return m_node - rhs.m_node; }
+            View operator[](difference_type n) const noexcept
+            { return View(m_image, m_node[n]); }
+
+            bool operator==(Iterator const & rhs) const noexcept
+            { return m_node == rhs.m_node; }
+            bool operator!=(Iterator const & rhs) const noexcept
+            { return m_node != rhs.m_node; }
+            bool operator<(Iterator const & rhs) const noexcept
+            { return m_node < rhs.m_node; }
+            bool operator<=(Iterator const & rhs) const noexcept
+            { return m_node <= rhs.m_node; }
+            bool operator>(Iterator const & rhs) const noexcept
+            { return m_node > rhs.m_node; }
+            bool operator>=(Iterator const & rhs) const noexcept
+            { return m_node >= rhs.m_node; }
+
+        private: /* Methods: */
+
+            Iterator(char const * image, Node const * node) noexcept
+                : m_image(image)
+                , m_node(node)
+            {}
+
+        private: /* Fields: */
+
+            char const * m_image;
+            Node const * m_node;
+
+        }; /* class Iterator */
+
+    public: /* Methods: */
+
+        StringView key() const noexcept;
+
+        bool empty() const noexcept;
+        SizeType size() const noexcept;
+
+        /** \returns an iterator over the direct children in file order. */
+        Iterator begin() const noexcept;
+        Iterator end() const noexcept;
+
+        bool hasValue() const noexcept;
+        bool hasValue(Path const & path) const noexcept;
+        bool hasSection() const noexcept;
+        bool hasSection(Path const & path) const noexcept;
+
+        template <typename T>
+        auto value() const
+                -> typename std::enable_if<
+                        Configuration::isReadableValueType<T>,
+                        T
+                    >::type;
+
+        template <typename T>
+        auto get(Path const & path_) const
+                -> typename std::enable_if<
+                        Configuration::isReadableValueType<T>,
+                        T
+                    >::type;
+
+        template <typename T>
+        auto get(Path const & path_, DefaultValueType<T> defaultValue) const
+                -> typename std::enable_if<
+                        Configuration::isReadableValueType<T>,
+                        T
+                    >::type;
+
+        template <typename T>
+        auto tryValue() const noexcept
+                -> typename std::enable_if<
+                        Configuration::isReadableValueType<T>,
+                        GetResult<T>
+                    >::type;
+
+        template <typename T>
+        auto tryGet(Path const & path_) const noexcept
+                -> typename std::enable_if<
+                        Configuration::isReadableValueType<T>,
+                        GetResult<T>
+                    >::type;
+
+        /** \throws Configuration::ValueNotFoundException */
+        StringView valueView() const;
+
+        /** \throws Configuration::ValueNotFoundException */
+        StringView getView(Path const & path_) const;
+
+        StringView getView(Path const & path_, StringView defaultValue)
+                const noexcept;
+
+        /** \throws Configuration::SectionNotFoundException */
+        View section(Path const & path) const;
+
+    private: /* Methods: */
+
+        View(char const * image, Node const & node) noexcept
+            : m_image(image)
+            , m_node(&node)
+        {}
+
+        Node const * findChild(Path const & path) const noexcept;
+
+    private: /* Fields: */
+
+        char const * m_image;
+        Node const * m_node;
+
+    }; /* class View */
+
+public: /* Methods: */
+
+    /**
+      \brief Creates a read-only snapshot of the given configuration.
+      \throws Configuration::InterpolationException if interpolating a value
+              fails.
+    */
+    explicit FrozenConfiguration(Configuration const & configuration);
+
+    FrozenConfiguration(FrozenConfiguration && move) noexcept;
+    FrozenConfiguration(FrozenConfiguration const &) = delete;
+    ~FrozenConfiguration() noexcept;
+
+    FrozenConfiguration & operator=(FrozenConfiguration && move) noexcept;
+    FrozenConfiguration & operator=(FrozenConfiguration const &) = delete;
+
+    /** \returns a view of the root of the snapshot. */
+    View view() const noexcept;
+
+    /** \returns the size of the snapshot image in bytes. */
+    std::size_t imageSize() const noexcept;
+
+    /**
+      \brief Writes the image to the given file descriptor, e.g. of a file or
+             a POSIX shared memory object.
+      \throws std::system_error
+    */
+    void writeImage(int fd) const;
+
+    /**
+      \brief Creates an anonymous memory file containing the image, sealed
+             against further modifications, which can be passed to other
+             processes and mapped with mapImage().
+      \returns the new file descriptor, which is owned by the caller.
+      \throws std::system_error
+    */
+    int createMemfd(char const * name = "sharemind-configuration") const;
+
+    /**
+      \brief Maps an image previously written by writeImage() or
+             createMemfd().
+
+      The image is validated before use, so it does not need to be trusted.
+      Images in files sealed against writing, shrinking and growing, e.g. by
+      createMemfd(), are mapped in place without copying. Other images are
+      copied into private memory, as they could be modified after being
+      validated. The file descriptor can be closed after this call.
+
+      \throws InvalidImageException if the file does not contain a valid
+              image.
+      \throws MapException if mapping the file failed.
+      \throws std::system_error
+    */
+    static FrozenConfiguration mapImage(int fd);
+
+private: /* Methods: */
+
+    FrozenConfiguration(char * image, std::size_t mappingSize) noexcept
+        : m_image(image)
+        , m_mappingSize(mappingSize)
+    {}
+
+    void reset() noexcept;
+
+private: /* Fields: */
+
+    char * m_image = nullptr;
+    std::size_t m_mappingSize = 0u;
+
+};
+
+#define SHAREMIND_LIBCONFIGURATION_FROZENCONFIGURATION_H_(T) \
+    extern template T FrozenConfiguration::View::value<T>() const; \
+    extern template T FrozenConfiguration::View::get<T>(Path const &) const; \
+    extern template T FrozenConfiguration::View::get<T>( \
+            Path const &, \
+            DefaultValueType<T>) const; \
+    extern template FrozenConfiguration::GetResult<T> \
+    FrozenConfiguration::View::tryValue<T>() const noexcept; \
+    extern template FrozenConfiguration::GetResult<T> \
+    FrozenConfiguration::View::tryGet<T>(Path const &) const noexcept;
+SHAREMIND_LIBCONFIGURATION_FOR_EACH_VALUE_TYPE(
+        SHAREMIND_LIBCONFIGURATION_FROZENCONFIGURATION_H_)
+#undef SHAREMIND_LIBCONFIGURATION_FROZENCONFIGURATION_H_
+
+static_assert(std::is_trivially_copyable<FrozenConfiguration::View>::value,
+              "");
+
+} /* namespace sharemind { */
+
+#endif /* SHAREMIND_LIBCONFIGURATION_FROZENCONFIGURATION_H */
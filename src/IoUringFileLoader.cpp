@@ -0,0 +1,459 @@
+/*
+ * Copyright (C) 2017 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+
+#include "IoUringFileLoader_p.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <limits>
+#include <system_error>
+#include <unistd.h>
+
+#ifdef __has_include
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+// IORING_OP_OPENAT, IORING_OP_STATX and IORING_OP_READ appeared in Linux 5.6:
+#ifdef IORING_FEAT_RW_CUR_POS
+#define SHAREMIND_LIBCONFIGURATION_HAVE_IO_URING
+#endif
+#endif
+#endif
+
+#ifdef SHAREMIND_LIBCONFIGURATION_HAVE_IO_URING
+#include <sys/stat.h>
+#include <linux/stat.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/sysmacros.h>
+#endif
+
+
+namespace sharemind {
+
+#ifdef SHAREMIND_LIBCONFIGURATION_HAVE_IO_URING
+
+namespace {
+
+constexpr std::size_t const maxReadSize = 1u << 30u;
+
+[[noreturn]] void throwErrno(int const e)
+{ throw std::system_error(e, std::system_category()); }
+
+[[noreturn]] void throwErrno() { throwErrno(errno); }
+
+} // anonymous namespace
+
+struct IoUringFileLoader::Ring {
+
+/* Methods: */
+
+    Ring() {
+        ::io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        m_fd = static_cast<int>(::syscall(__NR_io_uring_setup,
+                                          ringEntries,
+                                          &params));
+        if (m_fd < 0)
+            throwErrno();
+        try {
+            checkSupportedOperations();
+            mapRings(params);
+        } catch (...) {
+            unmap();
+            ::close(m_fd);
+            throw;
+        }
+    }
+
+    ~Ring() noexcept {
+        unmap();
+        ::close(m_fd);
+    }
+
+    void checkSupportedOperations() {
+        constexpr static unsigned const maxOps = 256u;
+        std::unique_ptr<char[]> buffer(
+                new char[sizeof(::io_uring_probe)
+                         + maxOps * sizeof(::io_uring_probe_op)]());
+        auto * const probe = reinterpret_cast<::io_uring_probe *>(buffer.get());
+        if (::syscall(__NR_io_uring_register,
+                      m_fd,
+                      IORING_REGISTER_PROBE,
+                      probe,
+                      maxOps) < 0)
+            throwErrno();
+        for (unsigned const op : {IORING_OP_OPENAT,
+                                  IORING_OP_STATX,
+                                  IORING_OP_READ})
+            if ((op > probe->last_op)
+                || (op >= probe->ops_len)
+                || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED))
+                throwErrno(EOPNOTSUPP);
+    }
+
+    void mapRings(::io_uring_params const & params) {
+        m_sqRingSize = params.sq_off.array
+                       + params.sq_entries * sizeof(unsigned);
+        m_cqRingSize = params.cq_off.cqes
+                       + params.cq_entries * sizeof(::io_uring_cqe);
+        bool const singleMmap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (singleMmap)
+            m_sqRingSize = m_cqRingSize =
+                    std::max(m_sqRingSize, m_cqRingSize);
+        m_sqRing = ::mmap(nullptr,
+                          m_sqRingSize,
+                          PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE,
+                          m_fd,
+                          IORING_OFF_SQ_RING);
+        if (m_sqRing == MAP_FAILED)
+            throwErrno();
+        if (singleMmap) {
+            m_cqRing = m_sqRing;
+        } else {
+            m_cqRing = ::mmap(nullptr,
+                              m_cqRingSize,
+                              PROT_READ | PROT_WRITE,
+                              MAP_SHARED | MAP_POPULATE,
+                              m_fd,
+                              IORING_OFF_CQ_RING);
+            if (m_cqRing == MAP_FAILED)
+                throwErrno();
+        }
+        m_sqesSize = params.sq_entries * sizeof(::io_uring_sqe);
+        auto const sqes = ::mmap(nullptr,
+                                 m_sqesSize,
+                                 PROT_READ | PROT_WRITE,
+                                 MAP_SHARED | MAP_POPULATE,
+                                 m_fd,
+                                 IORING_OFF_SQES);
+        if (sqes == MAP_FAILED)
+            throwErrno();
+        m_sqes = static_cast<::io_uring_sqe *>(sqes);
+
+        auto const sq = static_cast<char *>(m_sqRing);
+        m_sqTail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+        m_sqMask = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+        m_sqArray = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+        m_sqEntries = params.sq_entries;
+        m_localSqTail = *m_sqTail;
+
+        auto const cq = static_cast<char *>(m_cqRing);
+        m_cqHead = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+        m_cqTail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+        m_cqMask = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+        m_cqes = reinterpret_cast<::io_uring_cqe *>(cq + params.cq_off.cqes);
+    }
+
+    void unmap() noexcept {
+        if (m_sqes)
+            ::munmap(m_sqes, m_sqesSize);
+        if (m_cqRing != MAP_FAILED && m_cqRing != m_sqRing)
+            ::munmap(m_cqRing, m_cqRingSize);
+        if (m_sqRing != MAP_FAILED)
+            ::munmap(m_sqRing, m_sqRingSize);
+    }
+
+    unsigned capacity() const noexcept { return m_sqEntries; }
+
+    /** \brief Queues a new operation, which is not yet submitted. */
+    ::io_uring_sqe & prepare(std::uint8_t const opcode,
+                             int const fd,
+                             std::uint64_t const userData) noexcept
+    {
+        auto const index = m_localSqTail++ & m_sqMask;
+        auto & sqe = m_sqes[index];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = opcode;
+        sqe.fd = fd;
+        sqe.user_data = userData;
+        m_sqArray[index] = index;
+        ++m_prepared;
+        return sqe;
+    }
+
+    /**
+      \brief Submits all prepared operations and waits for their completion,
+             calling onCompletion(userData, result) for each of them.
+    */
+    template <typename OnCompletion>
+    void submitAndWait(OnCompletion && onCompletion) {
+        __atomic_store_n(m_sqTail, m_localSqTail, __ATOMIC_RELEASE);
+        auto toSubmit = m_prepared;
+        auto toComplete = m_prepared;
+        m_prepared = 0u;
+        for (;;) {
+            auto head = *m_cqHead;
+            auto const tail = __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE);
+            for (; head != tail; ++head, --toComplete) {
+                auto const & cqe = m_cqes[head & m_cqMask];
+                onCompletion(cqe.user_data, cqe.res);
+            }
+            __atomic_store_n(m_cqHead, head, __ATOMIC_RELEASE);
+            if (!toComplete)
+                return;
+            auto const r = ::syscall(__NR_io_uring_enter,
+                                     m_fd,
+                                     toSubmit,
+                                     toComplete,
+                                     IORING_ENTER_GETEVENTS,
+                                     nullptr,
+                                     0u);
+            if (r < 0) {
+                auto const e = errno;
+                if (e == EINTR)
+                    continue;
+                /* The operations not yet submitted remain queued, hence the
+                   ring can not be used any more. The submitted ones may still
+                   write to the memory given to them: */
+                m_failed = true;
+                m_quiescent = drain(toComplete - toSubmit);
+                throwErrno(e);
+            }
+            toSubmit -= static_cast<unsigned>(r);
+        }
+    }
+
+    /**
+      \brief Waits for the given number of submitted operations to complete,
+             ignoring their results.
+      \returns whether all of them completed.
+    */
+    bool drain(unsigned inFlight) noexcept {
+        for (;;) {
+            auto const head = *m_cqHead;
+            auto const tail = __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE);
+            inFlight -= tail - head;
+            __atomic_store_n(m_cqHead, tail, __ATOMIC_RELEASE);
+            if (!inFlight)
+                return true;
+            if ((::syscall(__NR_io_uring_enter,
+                           m_fd,
+                           0u,
+                           inFlight,
+                           IORING_ENTER_GETEVENTS,
+                           nullptr,
+                           0u) < 0)
+                && (errno != EINTR)
+                && (errno != EAGAIN)
+                && (errno != EBUSY))
+                return false;
+        }
+    }
+
+/* Fields: */
+
+    constexpr static unsigned const ringEntries = 256u;
+
+    int m_fd;
+    void * m_sqRing = MAP_FAILED;
+    void * m_cqRing = MAP_FAILED;
+    ::io_uring_sqe * m_sqes = nullptr;
+    std::size_t m_sqRingSize = 0u;
+    std::size_t m_cqRingSize = 0u;
+    std::size_t m_sqesSize = 0u;
+
+    unsigned * m_sqTail;
+    unsigned m_sqMask;
+    unsigned * m_sqArray;
+    unsigned m_sqEntries;
+    unsigned m_localSqTail;
+    unsigned m_prepared = 0u;
+
+    unsigned * m_cqHead;
+    unsigned * m_cqTail;
+    unsigned m_cqMask;
+    ::io_uring_cqe * m_cqes;
+
+    /* Whether io_uring_enter() has failed, after which no more operations may
+       be submitted, and whether all submitted operations had completed: */
+    bool m_failed = false;
+    bool m_quiescent = true;
+
+};
+
+constexpr unsigned const IoUringFileLoader::Ring::ringEntries;
+
+IoUringFileLoader::IoUringFileLoader()
+    : m_ring(std::make_unique<Ring>())
+{}
+
+IoUringFileLoader::~IoUringFileLoader() noexcept {}
+
+std::vector<IoUringFileLoader::File> IoUringFileLoader::load(
+        std::vector<char const *> const & paths,
+        std::uint64_t const maxFileSize)
+{
+    auto & ring = *m_ring;
+    if (ring.m_failed)
+        throwErrno(EBADFD);
+    std::vector<File> files(paths.size());
+    std::vector<int> fds;
+    std::vector<struct ::statx> stats;
+    std::vector<std::size_t> sizes;
+    std::vector<std::size_t> pending;
+    fds.reserve(ring.capacity());
+    stats.resize(ring.capacity());
+    sizes.reserve(ring.capacity());
+    pending.reserve(ring.capacity());
+
+    auto const closeFds =
+            [&fds]() noexcept {
+                for (auto const fd : fds)
+                    if (fd >= 0)
+                        ::close(fd);
+                fds.clear();
+            };
+
+    for (std::size_t start = 0u; start < paths.size();) {
+        auto const n = std::min<std::size_t>(ring.capacity(),
+                                             paths.size() - start);
+        auto * const batch = &files[start];
+        fds.assign(n, -1);
+        try {
+            // Open all files of the batch:
+            for (std::size_t i = 0u; i < n; ++i) {
+                auto & sqe = ring.prepare(IORING_OP_OPENAT, AT_FDCWD, i);
+                sqe.addr = reinterpret_cast<std::uintptr_t>(paths[start + i]);
+                sqe.open_flags = O_RDONLY | O_CLOEXEC | O_NOCTTY;
+            }
+            ring.submitAndWait(
+                        [&fds](std::uint64_t const i, int const r) noexcept
+                        { fds[i] = r; });
+
+            // Query the sizes and identities of all opened files:
+            for (std::size_t i = 0u; i < n; ++i) {
+                if (fds[i] < 0)
+                    continue;
+                auto & sqe = ring.prepare(IORING_OP_STATX, fds[i], i);
+                sqe.addr = reinterpret_cast<std::uintptr_t>("");
+                sqe.len = STATX_TYPE | STATX_INO | STATX_SIZE;
+                sqe.off = reinterpret_cast<std::uintptr_t>(&stats[i]);
+                sqe.statx_flags = AT_EMPTY_PATH;
+            }
+            ring.submitAndWait(
+                        [&fds](std::uint64_t const i, int const r) noexcept {
+                            if (r < 0) {
+                                ::close(fds[i]);
+                                fds[i] = -1;
+                            }
+                        });
+
+            /* Read all regular files, allocating an extra byte to detect
+               files which have grown in the meantime: */
+            pending.clear();
+            sizes.assign(n, 0u);
+            for (std::size_t i = 0u; i < n; ++i) {
+                if (fds[i] < 0)
+                    continue;
+                auto const & s = stats[i];
+                if ((s.stx_mode & S_IFMT) != S_IFREG
+                    || s.stx_size >= std::numeric_limits<std::size_t>::max()
+                    || s.stx_size > maxFileSize)
+                    continue;
+                batch[i].contents.resize(
+                            static_cast<std::size_t>(s.stx_size) + 1u);
+                batch[i].deviceId = makedev(s.stx_dev_major, s.stx_dev_minor);
+                batch[i].inode = s.stx_ino;
+                pending.emplace_back(i);
+            }
+            while (!pending.empty()) {
+                for (auto const i : pending) {
+                    auto & contents = batch[i].contents;
+                    auto const offset = sizes[i];
+                    auto & sqe = ring.prepare(IORING_OP_READ, fds[i], i);
+                    sqe.addr =
+                            reinterpret_cast<std::uintptr_t>(&contents[offset]);
+                    sqe.len = static_cast<std::uint32_t>(
+                                std::min<std::size_t>(contents.size() - offset,
+                                                      maxReadSize));
+                    sqe.off = offset;
+                }
+                pending.clear();
+                ring.submitAndWait(
+                        [&](std::uint64_t const i, int const r) noexcept {
+                            auto & file = batch[i];
+                            if (r < 0) {
+                                file.contents.clear();
+                                return;
+                            }
+                            sizes[i] += static_cast<std::size_t>(r);
+                            if (sizes[i] > maxFileSize) {
+                                // Grown too large, let the caller fail:
+                                file.contents.clear();
+                                return;
+                            }
+                            if (r > 0
+                                && (sizes[i] == file.contents.size()
+                                    || static_cast<std::size_t>(r)
+                                       == maxReadSize))
+                            {
+                                pending.emplace_back(i);
+                            } else {
+                                file.contents.resize(sizes[i]);
+                                file.loaded = true;
+                            }
+                        });
+                for (auto const i : pending) {
+                    auto & contents = batch[i].contents;
+                    if (sizes[i] < contents.size())
+                        continue;
+                    if (contents.size() > contents.max_size() / 2u)
+                        throw std::bad_alloc();
+                    contents.resize(contents.size() * 2u);
+                }
+            }
+        } catch (...) {
+            if (!ring.m_quiescent) {
+                /* Operations still in flight may write to the buffers and
+                   to the statx results at any time, hence these are leaked
+                   on purpose: */
+                new std::vector<File>(std::move(files));
+                new std::vector<struct ::statx>(std::move(stats));
+            }
+            closeFds();
+            throw;
+        }
+        closeFds();
+        start += n;
+    }
+    return files;
+}
+
+#else /* SHAREMIND_LIBCONFIGURATION_HAVE_IO_URING */
+
+struct IoUringFileLoader::Ring {};
+
+IoUringFileLoader::IoUringFileLoader()
+{ throw std::system_error(ENOSYS, std::system_category()); }
+
+IoUringFileLoader::~IoUringFileLoader() noexcept {}
+
+std::vector<IoUringFileLoader::File> IoUringFileLoader::load(
+        std::vector<char const *> const &,
+        std::uint64_t)
+{ throw std::system_error(ENOSYS, std::system_category()); }
+
+#endif /* SHAREMIND_LIBCONFIGURATION_HAVE_IO_URING */
+
+} /* namespace sharemind { */
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2017 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+
+#ifndef SHAREMIND_LIBCONFIGURATION_IOURINGFILELOADER_P_H
+#define SHAREMIND_LIBCONFIGURATION_IOURINGFILELOADER_P_H
+
+#include <cstdint>
+#include <memory>
+#include <sharemind/visibility.h>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+
+namespace sharemind {
+
+/**
+  \brief Reads the contents of many files at once using Linux io_uring, by
+         submitting the open, statx and read operations of up to a ring's
+         worth of files in a single system call per phase.
+*/
+class SHAREMIND_VISIBILITY_INTERNAL IoUringFileLoader {
+
+public: /* Types: */
+
+    struct File {
+        /**
+          \brief Whether the file was loaded. Files which could not be loaded,
+                 e.g. because they could not be opened or are not regular
+                 files, are to be opened and read the usual way, which then
+                 reports any errors.
+        */
+        bool loaded = false;
+        std::string contents;
+        ::dev_t deviceId = 0u;
+        ::ino_t inode = 0u;
+    };
+
+public: /* Methods: */
+
+    /**
+      \throws std::system_error if io_uring or any of the required operations
+                                is not supported by the system.
+    */
+    IoUringFileLoader();
+    IoUringFileLoader(IoUringFileLoader &&) = delete;
+    IoUringFileLoader(IoUringFileLoader const &) = delete;
+    ~IoUringFileLoader() noexcept;
+
+    IoUringFileLoader & operator=(IoUringFileLoader &&) = delete;
+    IoUringFileLoader & operator=(IoUringFileLoader const &) = delete;
+
+    /**
+      \returns the loaded files in the order of the given paths. Files larger
+               than maxFileSize bytes are not loaded.
+      \throws std::system_error if submitting the operations fails, after
+                                which this loader can no longer be used.
+    */
+    std::vector<File> load(std::vector<char const *> const & paths,
+                           std::uint64_t maxFileSize);
+
+private: /* Fields: */
+
+    struct Ring;
+    std::unique_ptr<Ring> m_ring;
+
+}; /* class IoUringFileLoader */
+
+} /* namespace sharemind { */
+
+#endif /* SHAREMIND_LIBCONFIGURATION_IOURINGFILELOADER_P_H */
@@ -0,0 +1,302 @@
+/*
+ * Copyright (C) 2017 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#ifndef SHAREMIND_LIBCONFIGURATION_STRINGHASHMAP_H
+#define SHAREMIND_LIBCONFIGURATION_STRINGHASHMAP_H
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <sharemind/StringView.h>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+namespace sharemind {
+
+/**
+  \returns a 64-bit FNV-1a based hash of the given string, folded to the size
+           of std::size_t. Being constexpr, it can be used to precompute the
+           hashes of constant keys.
+*/
+constexpr inline std::size_t stringHash(char const * data, std::size_t size)
+        noexcept
+{
+    std::uint64_t h = 14695981039346656037u;
+    for (; size; --size, ++data) {
+        h ^= static_cast<unsigned char>(*data);
+        h *= 1099511628211u;
+    }
+    h ^= h >> 32u; // FNV-1a low bits are weak, fold in the high bits.
+    return static_cast<std::size_t>(h);
+}
+
+inline std::size_t stringHash(StringView str) noexcept
+{ return stringHash(str.data(), str.size()); }
+
+/**
+  \brief An insertion-ordered open-addressing hash map with string keys which
+         supports heterogeneous lookups by StringView and lookups by
+         precomputed hashes (see stringHash()).
+  \tparam Value the type of mapped values.
+  \tparam Key the type of stored keys, either std::string or StringView. In the
+              latter case the caller must ensure that the referenced strings
+              outlive the map.
+  \note Pointers returned by the lookup and insertion functions are invalidated
+        by subsequent insertions and erasures.
+*/
+template <typename Value, typename Key = std::string>
+class StringHashMap {
+
+    static_assert(std::is_same<Key, std::string>::value
+                  || std::is_same<Key, StringView>::value, "");
+
+public: /* Types: */
+
+    using SizeType = std::size_t;
+
+    struct Entry {
+
+        template <typename ... Args>
+        Entry(Key key_, std::size_t hash_, Args && ... args)
+            : key(std::move(key_))
+            , hash(hash_)
+            , value(std::forward<Args>(args)...)
+        {}
+
+        Key key;
+        std::size_t hash;
+        Value value;
+
+    };
+
+    using ConstIterator = typename std::vector<Entry>::const_iterator;
+    using Iterator = typename std::vector<Entry>::iterator;
+
+public: /* Methods: */
+
+    bool empty() const noexcept { return m_entries.empty(); }
+    SizeType size() const noexcept { return m_entries.size(); }
+
+    /** \returns the entries in insertion order. */
+    Iterator begin() noexcept { return m_entries.begin(); }
+    ConstIterator begin() const noexcept { return m_entries.cbegin(); }
+    Iterator end() noexcept { return m_entries.end(); }
+    ConstIterator end() const noexcept { return m_entries.cend(); }
+
+    /**
+      \returns the heap memory allocated by the map itself, excluding memory
+               owned by the keys and values.
+    */
+    std::size_t allocatedBytes() const noexcept {
+        return m_entries.capacity() * sizeof(Entry)
+               + m_slots.capacity() * sizeof(SizeType);
+    }
+
+    void clear() noexcept {
+        m_entries.clear();
+        m_slots.clear();
+    }
+
+    void reserve(SizeType size) {
+        m_entries.reserve(size);
+        if (size > maxSizeForSlots(m_slots.size()))
+            rehash(slotsForSize(size));
+    }
+
+    Value * find(StringView key) noexcept
+    { return find(key, stringHash(key)); }
+
+    Value const * find(StringView key) const noexcept
+    { return find(key, stringHash(key)); }
+
+    Value * find(StringView key, std::size_t const hash) noexcept {
+        auto const i = findIndex(key, hash);
+        return i ? &m_entries[i - 1u].value : nullptr;
+    }
+
+    Value const * find(StringView key, std::size_t const hash) const noexcept {
+        auto const i = findIndex(key, hash);
+        return i ? &m_entries[i - 1u].value : nullptr;
+    }
+
+    /**
+      \brief Inserts a new entry unless an entry with the given key already
+             exists.
+      \returns a pointer to the value mapped to the given key and whether a new
+               entry was inserted.
+    */
+    template <typename ... Args>
+    std::pair<Value *, bool> tryEmplace(Key key, Args && ... args) {
+        auto const hash = stringHash(StringView(key));
+        return tryEmplaceHashed(std::move(key),
+                                hash,
+                                std::forward<Args>(args)...);
+    }
+
+    /**
+      \brief Like tryEmplace(), but uses the given hash of the key instead of
+             computing it.
+      \pre hash == stringHash(key)
+    */
+    template <typename ... Args>
+    std::pair<Value *, bool> tryEmplaceHashed(Key key,
+                                              std::size_t const hash,
+                                              Args && ... args)
+    {
+        assert(hash == stringHash(StringView(key)));
+        if (auto const i = findIndex(StringView(key), hash))
+            return {&m_entries[i - 1u].value, false};
+        if (m_entries.size() >= maxSizeForSlots(m_slots.size())) {
+            if (m_slots.size() > std::numeric_limits<SizeType>::max() / 2u)
+                throw std::bad_alloc();
+            rehash(m_slots.empty() ? minSlots : m_slots.size() * 2u);
+        }
+        m_entries.emplace_back(std::move(key),
+                               hash,
+                               std::forward<Args>(args)...);
+        auto const mask = m_slots.size() - 1u;
+        for (auto slot = hash & mask;; slot = (slot + 1u) & mask) {
+            if (!m_slots[slot]) {
+                m_slots[slot] = m_entries.size();
+                break;
+            }
+        }
+        return {&m_entries.back().value, true};
+    }
+
+    /**
+      \brief Erases the entry with the given key, if any.
+      \note The last entry is moved into the place of the erased one, hence
+            this changes the iteration order of the remaining entries.
+      \returns whether an entry was erased.
+    */
+    bool erase(StringView key) noexcept { return erase(key, stringHash(key)); }
+
+    bool erase(StringView key, std::size_t const hash) noexcept {
+        auto const i = findIndex(key, hash);
+        if (!i)
+            return false;
+        auto const mask = m_slots.size() - 1u;
+        auto hole = slotOf(i);
+
+        /* Backward shift deletion, moving every following entry in the probe
+           sequence which would not be found past the hole into the hole: */
+        for (auto slot = (hole + 1u) & mask;
+             m_slots[slot];
+             slot = (slot + 1u) & mask)
+        {
+            auto const home = m_entries[m_slots[slot] - 1u].hash & mask;
+            if (((slot - home) & mask) >= ((slot - hole) & mask)) {
+                m_slots[hole] = m_slots[slot];
+                hole = slot;
+            }
+        }
+        m_slots[hole] = 0u;
+
+        if (i != m_entries.size()) {
+            m_slots[slotOf(m_entries.size())] = i;
+            m_entries[i - 1u] = std::move(m_entries.back());
+        }
+        m_entries.pop_back();
+        return true;
+    }
+
+private: /* Methods: */
+
+    /** \returns the slot of the entry with the given index plus one. */
+    SizeType slotOf(SizeType const i) const noexcept {
+        assert(i && i <= m_entries.size());
+        auto const mask = m_slots.size() - 1u;
+        for (auto slot = m_entries[i - 1u].hash & mask;;
+             slot = (slot + 1u) & mask)
+            if (m_slots[slot] == i)
+                return slot;
+    }
+
+    // Keep the load factor at most 1/2:
+    static SizeType maxSizeForSlots(SizeType const slots) noexcept
+    { return slots / 2u; }
+
+    static SizeType slotsForSize(SizeType const size) {
+        SizeType slots = minSlots;
+        while (maxSizeForSlots(slots) < size) {
+            if (slots > std::numeric_limits<SizeType>::max() / 2u)
+                throw std::bad_alloc();
+            slots *= 2u;
+        }
+        return slots;
+    }
+
+    /** \returns the index of the matching entry plus one, or zero. */
+    SizeType findIndex(StringView key, std::size_t const hash) const noexcept {
+        if (m_slots.empty())
+            return 0u;
+        auto const mask = m_slots.size() - 1u;
+        for (auto slot = hash & mask;; slot = (slot + 1u) & mask) {
+            auto const i = m_slots[slot];
+            if (!i)
+                return 0u;
+            auto const & entry = m_entries[i - 1u];
+            if (entry.hash == hash && StringView(entry.key) == key)
+                return i;
+        }
+    }
+
+    void rehash(SizeType const newSlotCount) {
+        assert(newSlotCount >= minSlots);
+        assert(!(newSlotCount & (newSlotCount - 1u)));
+        std::vector<SizeType> slots(newSlotCount, 0u);
+        auto const mask = newSlotCount - 1u;
+        for (SizeType i = 0u; i < m_entries.size(); ++i) {
+            for (auto slot = m_entries[i].hash & mask;;
+                 slot = (slot + 1u) & mask)
+            {
+                if (!slots[slot]) {
+                    slots[slot] = i + 1u;
+                    break;
+                }
+            }
+        }
+        m_slots = std::move(slots);
+    }
+
+private: /* Fields: */
+
+    static constexpr SizeType const minSlots = 8u;
+
+    std::vector<Entry> m_entries;
+
+    /* Indexes of entries in m_entries plus one, zero denoting free slots. The
+       size of this vector is always either zero or a power of two. */
+    std::vector<SizeType> m_slots;
+
+};
+
+template <typename Value, typename Key>
+constexpr typename StringHashMap<Value, Key>::SizeType const
+StringHashMap<Value, Key>::minSlots;
+
+} /* namespace sharemind { */
+
+#endif /* SHAREMIND_LIBCONFIGURATION_STRINGHASHMAP_H */
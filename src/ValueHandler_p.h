@@ -0,0 +1,321 @@
+/*
+ * Copyright (C) 2017 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#ifndef SHAREMIND_LIBCONFIGURATION_VALUEHANDLER_P_H
+#define SHAREMIND_LIBCONFIGURATION_VALUEHANDLER_P_H
+
+#include <algorithm>
+#include <array>
+#include <boost/property_tree/ptree.hpp>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <istream>
+#include <limits>
+#include <locale>
+#include <sharemind/StringView.h>
+#include <streambuf>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "ByteSize.h"
+
+
+namespace sharemind {
+namespace ValueHandlerDetail {
+
+using namespace StringViewLiterals;
+
+/** \brief A read-only stream buffer over the characters of a StringView. */
+class StringViewStreamBuf: public std::streambuf {
+
+public: /* Methods: */
+
+    explicit StringViewStreamBuf(StringView const value) noexcept {
+        auto const begin = const_cast<char *>(value.data());
+        setg(begin, begin, begin + value.size());
+    }
+
+};
+
+struct UnitSuffix {
+    StringView suffix;
+    std::uint64_t numerator;
+    std::uint64_t denominator;
+};
+
+/*
+  Value handlers provide tryParse(value, out), which returns whether the value
+  was successfully parsed into out and throws only on allocation failures, and
+  generateDefault(defaultValue).
+*/
+template <typename T> struct ValueHandler {
+    // Parses like boost::property_tree::stream_translator, but without copying
+    // the value into a std::istringstream:
+    static bool tryParse(StringView const value, T & out) {
+        StringViewStreamBuf buffer(value);
+        std::istream stream(&buffer);
+        stream.imbue(std::locale());
+        T r;
+        boost::property_tree::customize_stream<
+                char,
+                std::char_traits<char>,
+                T>::extract(stream, r);
+        if (stream.fail() || stream.bad()
+            || (stream.get() != std::char_traits<char>::eof()))
+            return false;
+        out = std::move(r);
+        return true;
+    }
+    static T generateDefault(T value) noexcept { return value; }
+};
+
+template <> struct ValueHandler<std::string> {
+    static bool tryParse(StringView const value, std::string & out) {
+        out.assign(value.data(), value.size());
+        return true;
+    }
+    static bool tryParse(std::string && value, std::string & out) noexcept {
+        out = std::move(value);
+        return true;
+    }
+    static std::string generateDefault(StringView value) { return value.str(); }
+};
+
+/**
+  \brief Parses values consisting of a non-negative decimal integer, optional
+         whitespace and an optional unit suffix.
+  \param[in] value the value to parse.
+  \param[in] suffixes the table of known suffixes, each with a numerator and
+                      denominator giving the size of the unit relative to the
+                      unit of the result. The empty suffix must be included in
+                      the table if the unit is optional.
+  \param[out] result where to store the result.
+  \returns whether parsing succeeded and the result is exactly representable.
+*/
+template <std::size_t N>
+bool parseWithUnitSuffix(StringView value,
+                         std::array<UnitSuffix, N> const & suffixes,
+                         std::uint64_t & result) noexcept
+{
+    constexpr static auto const whitespace = " \t\n\r"_sv;
+    value = value.trimmed(whitespace);
+    if (value.empty())
+        return false;
+
+    std::uint64_t n = 0u;
+    std::size_t i = 0u;
+    for (; (i < value.size()) && (value[i] >= '0') && (value[i] <= '9'); ++i) {
+        auto const digit = static_cast<std::uint64_t>(value[i] - '0');
+        if (n > (std::numeric_limits<std::uint64_t>::max() - digit) / 10u)
+            return false;
+        n = n * 10u + digit;
+    }
+    if (i == 0u)
+        return false;
+    value.removePrefix(i);
+    value = value.leftTrimmed(whitespace);
+
+    for (auto const & suffix : suffixes) {
+        if (value != suffix.suffix)
+            continue;
+        if (suffix.numerator != 1u) {
+            if (n > std::numeric_limits<std::uint64_t>::max()
+                    / suffix.numerator)
+                return false;
+            n *= suffix.numerator;
+        }
+        if (n % suffix.denominator)
+            return false;
+        result = n / suffix.denominator;
+        return true;
+    }
+    return false;
+}
+
+template <> struct ValueHandler<ByteSize> {
+    static bool tryParse(StringView const value, ByteSize & out) {
+        constexpr static std::uint64_t const ki = 1024u;
+        constexpr static std::uint64_t const k = 1000u;
+        static std::array<UnitSuffix, 21u> const suffixes{{
+            {""_sv, 1u, 1u},
+            {"B"_sv, 1u, 1u},
+            {"K"_sv, ki, 1u},
+            {"KiB"_sv, ki, 1u},
+            {"M"_sv, ki * ki, 1u},
+            {"MiB"_sv, ki * ki, 1u},
+            {"G"_sv, ki * ki * ki, 1u},
+            {"GiB"_sv, ki * ki * ki, 1u},
+            {"T"_sv, ki * ki * ki * ki, 1u},
+            {"TiB"_sv, ki * ki * ki * ki, 1u},
+            {"P"_sv, ki * ki * ki * ki * ki, 1u},
+            {"PiB"_sv, ki * ki * ki * ki * ki, 1u},
+            {"E"_sv, ki * ki * ki * ki * ki * ki, 1u},
+            {"EiB"_sv, ki * ki * ki * ki * ki * ki, 1u},
+            {"kB"_sv, k, 1u},
+            {"KB"_sv, k, 1u},
+            {"MB"_sv, k * k, 1u},
+            {"GB"_sv, k * k * k, 1u},
+            {"TB"_sv, k * k * k * k, 1u},
+            {"PB"_sv, k * k * k * k * k, 1u},
+            {"EB"_sv, k * k * k * k * k * k, 1u}
+        }};
+        std::uint64_t bytes;
+        if (!parseWithUnitSuffix(value, suffixes, bytes))
+            return false;
+        out = ByteSize(bytes);
+        return true;
+    }
+    static ByteSize generateDefault(ByteSize value) noexcept { return value; }
+};
+
+constexpr std::uint64_t gcd(std::uint64_t a, std::uint64_t b) noexcept {
+    while (b) {
+        auto const t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+/**
+  \returns the unit suffix of the given duration in the given period, e.g.
+           one minute expressed in milliseconds is 60000/1.
+*/
+template <typename Period, std::intmax_t Num, std::intmax_t Den>
+constexpr UnitSuffix durationSuffix(StringView const suffix) noexcept {
+    static_assert(Period::num > 0 && Period::den > 0, "");
+    // Num/Den seconds in units of Period::num/Period::den seconds:
+    return UnitSuffix{
+        suffix,
+        static_cast<std::uint64_t>(Num * Period::den)
+            / gcd(static_cast<std::uint64_t>(Num * Period::den),
+                  static_cast<std::uint64_t>(Den * Period::num)),
+        static_cast<std::uint64_t>(Den * Period::num)
+            / gcd(static_cast<std::uint64_t>(Num * Period::den),
+                  static_cast<std::uint64_t>(Den * Period::num))};
+}
+
+template <typename Rep, typename Period>
+struct ValueHandler<std::chrono::duration<Rep, Period> > {
+    using Duration = std::chrono::duration<Rep, Period>;
+    static bool tryParse(StringView const value, Duration & out) {
+        static std::array<UnitSuffix, 9u> const suffixes{{
+            {""_sv, 1u, 1u},
+            durationSuffix<Period, 1, 1000000000>("ns"_sv),
+            durationSuffix<Period, 1, 1000000>("us"_sv),
+            durationSuffix<Period, 1, 1000000>("\xc2\xb5s"_sv), // "\u00b5s"
+            durationSuffix<Period, 1, 1000>("ms"_sv),
+            durationSuffix<Period, 1, 1>("s"_sv),
+            durationSuffix<Period, 60, 1>("min"_sv),
+            durationSuffix<Period, 3600, 1>("h"_sv),
+            durationSuffix<Period, 86400, 1>("d"_sv)
+        }};
+        static_assert(std::is_signed<Rep>::value, "");
+        using URep = typename std::make_unsigned<Rep>::type;
+        std::uint64_t ticks;
+        if (!parseWithUnitSuffix(value, suffixes, ticks)
+            || (ticks > static_cast<URep>(std::numeric_limits<Rep>::max())))
+            return false;
+        out = Duration(static_cast<Rep>(ticks));
+        return true;
+    }
+    static Duration generateDefault(Duration value) noexcept { return value; }
+};
+
+inline bool isListWhitespace(char const c) noexcept {
+    switch (c) {
+    case ' ': case '\t': case '\n': case '\r': return true;
+    default: return false;
+    }
+}
+
+/**
+  \brief Splits list values into elements.
+
+  Values containing commas are split at commas, and the elements are trimmed of
+  whitespace. Other values are split at sequences of whitespace. Values
+  consisting only of whitespace contain no elements.
+  \returns false if f returned false for some element, in which case no
+           further elements were processed, and true otherwise.
+*/
+template <typename F>
+bool splitListValue(StringView value, F && f) {
+    constexpr static auto const whitespace = " \t\n\r"_sv;
+    value = value.trimmed(whitespace);
+    if (value.empty())
+        return true;
+    auto begin = value.data();
+    auto const end = begin + value.size();
+
+    // memchr() is usually vectorized, hence well suited to find separators:
+    if (auto comma =
+            static_cast<char const *>(std::memchr(begin, ',', value.size())))
+    {
+        for (;;) {
+            if (!f(StringView(begin, static_cast<std::size_t>(comma - begin))
+                        .trimmed(whitespace)))
+                return false;
+            begin = comma + 1;
+            comma = static_cast<char const *>(
+                        std::memchr(begin,
+                                    ',',
+                                    static_cast<std::size_t>(end - begin)));
+            if (!comma)
+                return f(StringView(begin,
+                                    static_cast<std::size_t>(end - begin))
+                            .trimmed(whitespace));
+        }
+    }
+
+    for (;;) {
+        auto const tokenEnd = std::find_if(begin, end, &isListWhitespace);
+        if (!f(StringView(begin, static_cast<std::size_t>(tokenEnd - begin))))
+            return false;
+        begin = std::find_if_not(tokenEnd, end, &isListWhitespace);
+        if (begin == end)
+            return true;
+    }
+}
+
+template <typename T> struct ValueHandler<std::vector<T> > {
+    static bool tryParse(StringView const value, std::vector<T> & out) {
+        std::vector<T> r;
+        if (!splitListValue(
+                    value,
+                    [&r](StringView const element) {
+                        r.emplace_back();
+                        return ValueHandler<T>::tryParse(element, r.back());
+                    }))
+            return false;
+        out = std::move(r);
+        return true;
+    }
+    static std::vector<T> generateDefault(std::vector<T> value) noexcept
+    { return value; }
+};
+
+} /* namespace ValueHandlerDetail { */
+
+using ValueHandlerDetail::ValueHandler;
+
+} /* namespace sharemind { */
+
+#endif /* SHAREMIND_LIBCONFIGURATION_VALUEHANDLER_P_H */
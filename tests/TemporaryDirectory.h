@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2017 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#ifndef SHAREMIND_LIBCONFIGURATION_TESTS_TEMPORARYDIRECTORY_H
+#define SHAREMIND_LIBCONFIGURATION_TESTS_TEMPORARYDIRECTORY_H
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/system/error_code.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
+
+namespace sharemind {
+
+/** \brief A temporary directory, removed with its contents on destruction. */
+class TemporaryDirectory {
+
+public: /* Methods: */
+
+    /** \param[in] name the prefix of the name of the directory in /tmp. */
+    explicit TemporaryDirectory(std::string const & name)
+        : m_path("/tmp/" + name + ".XXXXXX")
+    {
+        if (!::mkdtemp(&m_path[0u]))
+            throw std::runtime_error("mkdtemp() failed!");
+    }
+
+    TemporaryDirectory(TemporaryDirectory &&) = delete;
+    TemporaryDirectory(TemporaryDirectory const &) = delete;
+
+    ~TemporaryDirectory() noexcept {
+        boost::system::error_code error;
+        boost::filesystem::remove_all(m_path, error);
+        if (error)
+            std::fprintf(stderr,
+                         "Failed to remove %s: %s\n",
+                         m_path.c_str(),
+                         error.message().c_str());
+    }
+
+    TemporaryDirectory & operator=(TemporaryDirectory &&) = delete;
+    TemporaryDirectory & operator=(TemporaryDirectory const &) = delete;
+
+    std::string const & path() const noexcept { return m_path; }
+
+private: /* Fields: */
+
+    std::string m_path;
+
+};
+
+} /* namespace sharemind { */
+
+#endif /* SHAREMIND_LIBCONFIGURATION_TESTS_TEMPORARYDIRECTORY_H */
@@ -0,0 +1,186 @@
+/*
+ * Copyright (C) 2017 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#include "../src/Configuration.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <sharemind/TestAssert.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+
+using sharemind::Configuration;
+
+namespace {
+
+struct Expected {
+    char const * path;
+    std::uint64_t count;
+    bool hasValue;
+    bool hasSection;
+};
+
+void checkReport(std::vector<Configuration::AccessCount> const & report,
+                 std::vector<Expected> const & expected)
+{
+    SHAREMIND_TESTASSERT(report.size() == expected.size());
+    for (std::size_t i = 0u; i < report.size(); ++i) {
+        SHAREMIND_TESTASSERT(report[i].path.toString() == expected[i].path);
+        SHAREMIND_TESTASSERT(report[i].count == expected[i].count);
+        SHAREMIND_TESTASSERT(report[i].hasValue == expected[i].hasValue);
+        SHAREMIND_TESTASSERT(report[i].hasSection == expected[i].hasSection);
+    }
+}
+
+std::vector<std::string> unusedValues(Configuration const & conf) {
+    std::vector<std::string> r;
+    for (auto const & path : conf.unusedValues())
+        r.emplace_back(path.toString());
+    std::sort(r.begin(), r.end());
+    return r;
+}
+
+} // anonymous namespace
+
+int main() {
+    char filename[] = "/tmp/TestAccessTracking.XXXXXX";
+    {
+        auto const fd = ::mkstemp(filename);
+        SHAREMIND_TESTASSERT(fd >= 0);
+        ::close(fd);
+        std::ofstream f(filename);
+        f << "Top = 1\n"
+             "Unused = 2\n"
+             "Both = 3\n"
+             "[Both]\nInner = 4\n"
+             "[Section]\nA = 5\nB = 6\nC = 7\n";
+    }
+    Configuration conf(filename);
+    ::unlink(filename);
+
+    // Nothing is counted by default:
+    SHAREMIND_TESTASSERT(!conf.accessTracking());
+    SHAREMIND_TESTASSERT(conf.get<int>("Top") == 1);
+    SHAREMIND_TESTASSERT(conf.hasSection("Section"));
+    SHAREMIND_TESTASSERT(conf.section("Section").get<int>("A") == 5);
+    checkReport(conf.accessReport(),
+                {{"Both", 0u, true, true},
+                 {"Both.Inner", 0u, true, false},
+                 {"Section", 0u, false, true},
+                 {"Section.A", 0u, true, false},
+                 {"Section.B", 0u, true, false},
+                 {"Section.C", 0u, true, false},
+                 {"Top", 0u, true, false},
+                 {"Unused", 0u, true, false}});
+
+    conf.setAccessTracking(true);
+    SHAREMIND_TESTASSERT(conf.accessTracking());
+
+    // Reads count on the nodes read, whichever way they are reached:
+    SHAREMIND_TESTASSERT(conf.get<int>("Top") == 1);
+    SHAREMIND_TESTASSERT(conf.get<int>("Top", 9) == 1);
+    SHAREMIND_TESTASSERT(conf.tryGet<int>("Top"));
+    SHAREMIND_TESTASSERT(conf.hasValue("Both"));
+    SHAREMIND_TESTASSERT(conf.hasSection("Both"));
+    {
+        auto const section(conf.section("Section"));
+        SHAREMIND_TESTASSERT(section.get<int>("A") == 5);
+        SHAREMIND_TESTASSERT(section.getView("B") == "6");
+    }
+    SHAREMIND_TESTASSERT(conf.view().section("Section").get<int>("A") == 5);
+    for (auto const child : conf.children())
+        if (child.key() == "Both")
+            SHAREMIND_TESTASSERT(child.get<int>("Inner") == 4);
+
+    // Missing paths do not count anywhere:
+    SHAREMIND_TESTASSERT(!conf.hasValue("Missing"));
+    SHAREMIND_TESTASSERT(!conf.hasSection("Section.Missing"));
+    SHAREMIND_TESTASSERT(conf.get<int>("Section.Missing", 8) == 8);
+
+    // Sorted by decreasing count, then by path:
+    checkReport(conf.accessReport(),
+                {{"Top", 3u, true, false},
+                 {"Both", 2u, true, true},
+                 {"Section", 2u, false, true},
+                 {"Section.A", 2u, true, false},
+                 {"Both.Inner", 1u, true, false},
+                 {"Section.B", 1u, true, false},
+                 {"Section.C", 0u, true, false},
+                 {"Unused", 0u, true, false}});
+    SHAREMIND_TESTASSERT(
+            unusedValues(conf)
+            == (std::vector<std::string>{"Section.C", "Unused"}));
+
+    // Copies share their counters:
+    {
+        Configuration const copy(conf);
+        SHAREMIND_TESTASSERT(copy.accessTracking());
+        SHAREMIND_TESTASSERT(copy.get<int>("Unused") == 2);
+        SHAREMIND_TESTASSERT(unusedValues(conf)
+                             == std::vector<std::string>{"Section.C"});
+        SHAREMIND_TESTASSERT(unusedValues(copy)
+                             == std::vector<std::string>{"Section.C"});
+    }
+
+    // Reports and resets of subtrees, with paths relative to the subtree:
+    {
+        auto section(conf.section("Section"));
+        checkReport(section.accessReport(),
+                    {{"", 3u, false, true},
+                     {"A", 2u, true, false},
+                     {"B", 1u, true, false},
+                     {"C", 0u, true, false}});
+        section.get<int>("C");
+        SHAREMIND_TESTASSERT(section.unusedValues().empty());
+        section.resetAccessCounts();
+        checkReport(section.accessReport(),
+                    {{"", 0u, false, true},
+                     {"A", 0u, true, false},
+                     {"B", 0u, true, false},
+                     {"C", 0u, true, false}});
+        SHAREMIND_TESTASSERT(section.unusedValues().size() == 3u);
+    }
+    checkReport(conf.accessReport(),
+                {{"Top", 3u, true, false},
+                 {"Both", 2u, true, true},
+                 {"Both.Inner", 1u, true, false},
+                 {"Unused", 1u, true, false},
+                 {"Section", 0u, false, true},
+                 {"Section.A", 0u, true, false},
+                 {"Section.B", 0u, true, false},
+                 {"Section.C", 0u, true, false}});
+
+    // Resetting the whole tree:
+    conf.resetAccessCounts();
+    for (auto const & accessCount : conf.accessReport())
+        SHAREMIND_TESTASSERT(accessCount.count == 0u);
+    SHAREMIND_TESTASSERT(unusedValues(conf).size() == 7u);
+
+    // Disabling tracking stops counting, but keeps the counts:
+    SHAREMIND_TESTASSERT(conf.get<int>("Top") == 1);
+    conf.setAccessTracking(false);
+    SHAREMIND_TESTASSERT(conf.get<int>("Top") == 1);
+    SHAREMIND_TESTASSERT(conf.get<int>("Unused") == 2);
+    SHAREMIND_TESTASSERT(conf.accessReport().front().path.toString() == "Top");
+    SHAREMIND_TESTASSERT(conf.accessReport().front().count == 1u);
+    SHAREMIND_TESTASSERT(unusedValues(conf).size() == 6u);
+}
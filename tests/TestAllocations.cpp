@@ -0,0 +1,243 @@
+/*
+ * Copyright (C) 2017 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#include "../src/Configuration.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <sharemind/TestAssert.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+
+using sharemind::ByteSize;
+using sharemind::Configuration;
+using sharemind::Path;
+
+namespace {
+
+/* The number of heap allocations made via operator new or malloc(): */
+std::atomic<std::size_t> allocationCount{0u};
+
+template <typename F>
+std::size_t countAllocations(F && f) {
+    f(); // Warm up function-local statics and caches
+    auto const before = allocationCount.load();
+    f();
+    return allocationCount.load() - before;
+}
+
+void checkAllocations(std::size_t const expected,
+                      std::size_t const actual,
+                      char const * const code)
+{
+    if (actual != expected)
+        std::fprintf(stderr,
+                     "Expected %zu allocations, but got %zu: %s\n",
+                     expected,
+                     actual,
+                     code);
+    SHAREMIND_TESTASSERT(actual == expected);
+}
+
+#define TEST_ALLOCATIONS(expected, ...) \
+    checkAllocations((expected), \
+                     countAllocations([&] { __VA_ARGS__; }), \
+                     #__VA_ARGS__)
+
+} // anonymous namespace
+
+/* AddressSanitizer replaces the C allocation functions itself: */
+#if defined(__SANITIZE_ADDRESS__)
+#define SHAREMIND_TEST_ASAN
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define SHAREMIND_TEST_ASAN
+#endif
+#endif
+
+#if defined(__GLIBC__) && !defined(SHAREMIND_TEST_ASAN)
+#define SHAREMIND_TEST_INTERPOSE_C_ALLOCATIONS
+#endif
+
+#ifdef SHAREMIND_TEST_INTERPOSE_C_ALLOCATIONS
+/* Interpose the C allocation functions to also count the allocations made by
+   C code and by operator new of the standard library: */
+extern "C" {
+
+void * __libc_malloc(std::size_t size);
+void * __libc_calloc(std::size_t count, std::size_t size);
+void * __libc_realloc(void * ptr, std::size_t size);
+
+void * malloc(std::size_t size) noexcept {
+    ++allocationCount;
+    return __libc_malloc(size);
+}
+
+void * calloc(std::size_t count, std::size_t size) noexcept {
+    ++allocationCount;
+    return __libc_calloc(count, size);
+}
+
+void * realloc(void * ptr, std::size_t size) noexcept {
+    ++allocationCount;
+    return __libc_realloc(ptr, size);
+}
+
+} // extern "C"
+#endif
+
+void * operator new(std::size_t size) {
+    #ifndef SHAREMIND_TEST_INTERPOSE_C_ALLOCATIONS
+    ++allocationCount;
+    #endif
+    if (auto * const ptr = std::malloc(size ? size : 1u))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void * operator new[](std::size_t size) { return operator new(size); }
+
+void * operator new(std::size_t size, std::nothrow_t const &) noexcept {
+    try {
+        return operator new(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void * operator new[](std::size_t size, std::nothrow_t const &) noexcept
+{ return operator new(size, std::nothrow); }
+
+void operator delete(void * ptr) noexcept { std::free(ptr); }
+void operator delete[](void * ptr) noexcept { std::free(ptr); }
+void operator delete(void * ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void * ptr, std::size_t) noexcept { std::free(ptr); }
+
+void operator delete(void * ptr, std::nothrow_t const &) noexcept
+{ std::free(ptr); }
+
+void operator delete[](void * ptr, std::nothrow_t const &) noexcept
+{ std::free(ptr); }
+
+int main() {
+    char filename[] = "/tmp/TestAllocations.XXXXXX";
+    {
+        auto const fd = ::mkstemp(filename);
+        SHAREMIND_TESTASSERT(fd >= 0);
+        ::close(fd);
+        std::ofstream f(filename);
+        f << "Top = 42\n"
+             "[Server]\n"
+             "Name = short\n"
+             "Host = a.host.name.long.enough.to.be.allocated.example\n"
+             "Port = 1234\n"
+             "Size = 64 MiB\n"
+             "Timeout = 1500 ms\n"
+             "Ports = 1, 2, 3\n"
+             "Short = %{Root}\n"
+             "Long = %{Root}/a/path/long/enough/to/be/allocated\n"
+             "[Client]\n"
+             "Name = client\n";
+    }
+    auto interpolation(std::make_shared<Configuration::Interpolation>());
+    interpolation->addVariable("Root", "/srv");
+    Configuration conf(filename, std::move(interpolation));
+    ::unlink(filename);
+
+    Path const server("Server");
+    Path const name("Server.Name");
+    Path const host("Server.Host");
+    Path const port("Server.Port");
+    Path const size("Server.Size");
+    Path const timeout("Server.Timeout");
+    Path const ports("Server.Ports");
+    Path const shortInterpolated("Server.Short");
+    Path const longInterpolated("Server.Long");
+    Path const missing("Server.Missing");
+    auto const view(conf.view());
+    auto const iterateChildren =
+            [&conf] {
+                for (auto const child : conf.children())
+                    child.key();
+            };
+    auto const iterateViews =
+            [&view] {
+                for (auto const section : view)
+                    for (auto const child : section)
+                        child.key();
+            };
+    auto const iterateConfigurations =
+            [&conf] {
+                for (auto const child : conf)
+                    child.key();
+            };
+
+    // Reads which must never allocate:
+    TEST_ALLOCATIONS(0u, conf.hasValue(port));
+    TEST_ALLOCATIONS(0u, conf.hasValue(missing));
+    TEST_ALLOCATIONS(0u, conf.hasSection(server));
+    TEST_ALLOCATIONS(0u, conf.getView(host));
+    TEST_ALLOCATIONS(0u, conf.get<std::string>(name));
+    TEST_ALLOCATIONS(0u, conf.get<int>(port));
+    TEST_ALLOCATIONS(0u, conf.tryGet<int>(port));
+    TEST_ALLOCATIONS(0u, conf.get<int>(missing, 5));
+    TEST_ALLOCATIONS(0u, conf.get<ByteSize>(size));
+    TEST_ALLOCATIONS(0u, conf.get<std::chrono::milliseconds>(timeout));
+    TEST_ALLOCATIONS(0u, view.section(server));
+    TEST_ALLOCATIONS(0u, view.get<int>(port));
+    TEST_ALLOCATIONS(0u, view.getView(host));
+    TEST_ALLOCATIONS(0u, iterateChildren());
+    TEST_ALLOCATIONS(0u, iterateViews());
+    TEST_ALLOCATIONS(0u, conf.getView(shortInterpolated));
+    TEST_ALLOCATIONS(0u, conf.get<std::string>(shortInterpolated));
+    TEST_ALLOCATIONS(0u, conf.interpolate("%{Root}"));
+
+    #ifdef __GLIBCXX__
+    /* The costs of the other reads with libstdc++. Values which do not fit
+       into the inline buffer of std::string are copied. Lists are built
+       element by element. Configuration objects own a copy of their path: */
+    TEST_ALLOCATIONS(1u, conf.get<std::string>(host));
+    TEST_ALLOCATIONS(3u, conf.get<std::vector<int> >(ports));
+    TEST_ALLOCATIONS(2u, conf.section(server));
+    TEST_ALLOCATIONS(6u, iterateConfigurations());
+    TEST_ALLOCATIONS(2u, conf.getView(longInterpolated));
+    TEST_ALLOCATIONS(2u, conf.get<std::string>(longInterpolated));
+    #endif
+
+    // With caching, parsed values are only copied:
+    conf.setParsedValueCaching(true);
+    TEST_ALLOCATIONS(0u, conf.get<int>(port));
+    TEST_ALLOCATIONS(0u, conf.tryGet<int>(port));
+    TEST_ALLOCATIONS(0u, conf.get<ByteSize>(size));
+    TEST_ALLOCATIONS(0u, view.get<int>(port));
+    #ifdef __GLIBCXX__
+    TEST_ALLOCATIONS(1u, conf.get<std::vector<int> >(ports));
+    #endif
+
+    // Access tracking only bumps counters:
+    conf.setAccessTracking(true);
+    TEST_ALLOCATIONS(0u, conf.get<int>(port));
+    TEST_ALLOCATIONS(0u, view.section(server));
+}
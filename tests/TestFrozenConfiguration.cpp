@@ -0,0 +1,175 @@
+/*
+ * Copyright (C) 2017 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#include "../src/FrozenConfiguration.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <sharemind/TestAssert.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+
+using sharemind::Configuration;
+using sharemind::FrozenConfiguration;
+
+namespace {
+
+void testView(FrozenConfiguration::View const view) {
+    SHAREMIND_TESTASSERT(view.size() == 3u);
+    std::vector<std::string> keys;
+    for (auto const child : view)
+        keys.emplace_back(child.key().str());
+    SHAREMIND_TESTASSERT(
+            (keys == std::vector<std::string>{"Top", "Peer2", "Peer1"}));
+    SHAREMIND_TESTASSERT(view.get<int>("Top") == 42);
+    SHAREMIND_TESTASSERT(view.get<std::string>("Peer1.Host") == "a.example");
+    SHAREMIND_TESTASSERT(view.get<std::uint16_t>("Peer2.Port") == 2000u);
+    SHAREMIND_TESTASSERT(view.get<int>("Peer3.Port", 7) == 7);
+    SHAREMIND_TESTASSERT(view.section("Peer1").get<int>("Port") == 1000);
+    SHAREMIND_TESTASSERT(view.hasSection("Peer2"));
+    SHAREMIND_TESTASSERT(!view.hasSection("Top"));
+    SHAREMIND_TESTASSERT(!view.hasValue("Peer2"));
+    SHAREMIND_TESTASSERT(
+            view.tryGet<int>("Peer1.Host").error()
+            == Configuration::GetError::ParseFailed);
+    SHAREMIND_TESTASSERT(
+            view.tryGet<int>("Peer1.Missing").error()
+            == Configuration::GetError::ValueNotFound);
+    bool thrown = false;
+    try {
+        view.section("Top");
+    } catch (Configuration::SectionNotFoundException const &) {
+        thrown = true;
+    }
+    SHAREMIND_TESTASSERT(thrown);
+}
+
+int createMemfdWithContents(std::string const & contents) {
+    // Like the library, do not rely on the glibc 2.27 memfd_create() wrapper:
+    auto const fd =
+            static_cast<int>(::syscall(SYS_memfd_create, "test", MFD_CLOEXEC));
+    SHAREMIND_TESTASSERT(fd >= 0);
+    SHAREMIND_TESTASSERT(
+            ::write(fd, contents.data(), contents.size())
+            == static_cast<::ssize_t>(contents.size()));
+    return fd;
+}
+
+} // anonymous namespace
+
+int main() {
+    char filename[] = "/tmp/TestFrozenConfiguration.XXXXXX";
+    {
+        auto const fd = ::mkstemp(filename);
+        SHAREMIND_TESTASSERT(fd >= 0);
+        ::close(fd);
+        std::ofstream f(filename);
+        f << "Top = 42\n"
+             "[Peer2]\nHost = b.example\nPort = 2000\n"
+             "[Peer1]\nHost = a.example\nPort = 1000\n";
+    }
+    Configuration const configuration(filename);
+    ::unlink(filename);
+
+    FrozenConfiguration const frozen(configuration);
+    testView(frozen.view());
+
+    // Export the image, then map it in another process:
+    auto const fd = frozen.createMemfd();
+    SHAREMIND_TESTASSERT(fd >= 0);
+    auto const pid = ::fork();
+    SHAREMIND_TESTASSERT(pid >= 0);
+    if (!pid) {
+        auto const mapped(FrozenConfiguration::mapImage(fd));
+        SHAREMIND_TESTASSERT(mapped.imageSize() == frozen.imageSize());
+        testView(mapped.view());
+        ::_exit(EXIT_SUCCESS);
+    }
+    int status;
+    SHAREMIND_TESTASSERT(::waitpid(pid, &status, 0) == pid);
+    SHAREMIND_TESTASSERT(WIFEXITED(status));
+    SHAREMIND_TESTASSERT(WEXITSTATUS(status) == EXIT_SUCCESS);
+
+    // The exported image is sealed:
+    SHAREMIND_TESTASSERT(::write(fd, "x", 1u) < 0);
+    SHAREMIND_TESTASSERT(::ftruncate(fd, 0) != 0);
+    ::close(fd);
+
+    // Invalid images are rejected:
+    std::string image;
+    {
+        auto const imageFd = createMemfdWithContents(std::string());
+        frozen.writeImage(imageFd);
+        SHAREMIND_TESTASSERT(::lseek(imageFd, 0, SEEK_SET) == 0);
+        image.resize(frozen.imageSize());
+        SHAREMIND_TESTASSERT(
+                ::read(imageFd, &image[0u], image.size())
+                == static_cast<::ssize_t>(image.size()));
+        testView(FrozenConfiguration::mapImage(imageFd).view());
+
+        // Images which are not sealed are copied:
+        auto const mapped(FrozenConfiguration::mapImage(imageFd));
+        std::string const zeroes(image.size(), '\0');
+        SHAREMIND_TESTASSERT(
+                ::pwrite(imageFd, zeroes.data(), zeroes.size(), 0)
+                == static_cast<::ssize_t>(zeroes.size()));
+        SHAREMIND_TESTASSERT(::ftruncate(imageFd, 0) == 0);
+        testView(mapped.view());
+        ::close(imageFd);
+    }
+    static auto const testInvalid =
+            [](std::string const & contents) {
+                auto const imageFd = createMemfdWithContents(contents);
+                bool thrown = false;
+                try {
+                    FrozenConfiguration::mapImage(imageFd);
+                } catch (FrozenConfiguration::InvalidImageException const &) {
+                    thrown = true;
+                }
+                ::close(imageFd);
+                SHAREMIND_TESTASSERT(thrown);
+            };
+    testInvalid(std::string());
+    testInvalid(image.substr(0u, image.size() - 1u));
+    {
+        auto badMagic(image);
+        badMagic[0u] = 'X';
+        testInvalid(badMagic);
+    }
+    // Corrupt every byte following the header, one at a time:
+    for (std::size_t i = 16u; i < image.size(); ++i) {
+        auto corrupt(image);
+        corrupt[i] = static_cast<char>(0xff);
+        auto const imageFd = createMemfdWithContents(corrupt);
+        try {
+            // Either rejected, or safe to read:
+            auto const mapped(FrozenConfiguration::mapImage(imageFd));
+            for (auto const child : mapped.view()) {
+                child.key();
+                child.tryGet<std::string>("Port");
+            }
+        } catch (FrozenConfiguration::InvalidImageException const &) {}
+        ::close(imageFd);
+    }
+}
@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) 2017 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#include "../src/Configuration.h"
+
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <sharemind/TestAssert.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+
+using sharemind::ByteSize;
+using sharemind::Configuration;
+
+namespace {
+
+template <typename E>
+bool isException(std::exception_ptr const & e) {
+    try {
+        std::rethrow_exception(e);
+    } catch (E const &) {
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+} // anonymous namespace
+
+int main() {
+    char filename[] = "/tmp/TestGetMany.XXXXXX";
+    {
+        auto const fd = ::mkstemp(filename);
+        SHAREMIND_TESTASSERT(fd >= 0);
+        ::close(fd);
+        std::ofstream f(filename);
+        f << "Top = 7\n"
+             "[Peer1]\n"
+             "Host = a.example\n"
+             "Port = 1000\n"
+             "Buffer = 64 MiB\n"
+             "Timeout = 1500 ms\n"
+             "[Peer2]\n"
+             "Host = b.example\n"
+             "Port = many\n"
+             "[Server]\n"
+             "Peers = 1, 2, 3\n";
+    }
+    Configuration const conf(filename);
+    ::unlink(filename);
+
+    using R = Configuration;
+
+    // Values of mixed types, in no particular order of their paths:
+    {
+        std::string peer2Host;
+        std::uint16_t peer1Port = 0u;
+        std::int32_t top = 0;
+        ByteSize buffer;
+        std::chrono::milliseconds timeout{};
+        std::string peer1Host;
+        std::vector<std::int32_t> peers;
+        std::int32_t missing = 0;
+        std::string missingSection;
+        std::int32_t sectionWithoutValue = 0;
+        conf.getMany({
+            R::getRequest("Peer2.Host", peer2Host),
+            R::getRequest("Peer1.Port", peer1Port),
+            R::getRequest("Top", top),
+            R::getRequest("Peer1.Buffer", buffer),
+            R::getRequest("Peer1.Timeout", timeout),
+            R::getRequest("Peer1.Host", peer1Host),
+            R::getRequest("Server.Peers", peers),
+            R::getRequest("Peer1.Missing", missing, 5),
+            R::getRequest("Missing.Name", missingSection, "none"),
+            R::getRequest("Peer1", sectionWithoutValue, 9)
+        });
+        SHAREMIND_TESTASSERT(peer2Host == "b.example");
+        SHAREMIND_TESTASSERT(peer1Port == 1000u);
+        SHAREMIND_TESTASSERT(top == 7);
+        SHAREMIND_TESTASSERT(buffer == ByteSize(64u * 1024u * 1024u));
+        SHAREMIND_TESTASSERT(timeout == std::chrono::milliseconds(1500));
+        SHAREMIND_TESTASSERT(peer1Host == "a.example");
+        SHAREMIND_TESTASSERT((peers == std::vector<std::int32_t>{1, 2, 3}));
+        SHAREMIND_TESTASSERT(missing == 5);
+        SHAREMIND_TESTASSERT(missingSection == "none");
+        SHAREMIND_TESTASSERT(sectionWithoutValue == 9);
+    }
+
+    // Requests relative to a section, and no requests at all:
+    {
+        std::uint16_t port = 0u;
+        std::string host;
+        conf.section("Peer1").getMany({R::getRequest("Port", port),
+                                       R::getRequest("Host", host)});
+        SHAREMIND_TESTASSERT(port == 1000u);
+        SHAREMIND_TESTASSERT(host == "a.example");
+        conf.getMany({});
+    }
+
+    // All failures are reported together, in the order of their paths:
+    {
+        std::uint16_t peer2Port = 0u;
+        std::string peer2Host;
+        std::int32_t peer1Missing = 0;
+        std::int32_t missingKey = 0;
+        std::int32_t peer1Host = 0;
+        std::int32_t top = 0;
+        std::int32_t peer1 = 0;
+        bool thrown = false;
+        try {
+            conf.getMany({
+                R::getRequest("Peer2.Port", peer2Port),
+                R::getRequest("Peer2.Host", peer2Host),
+                R::getRequest("Peer1.Missing", peer1Missing),
+                R::getRequest("Missing.Key", missingKey),
+                R::getRequest("Peer1.Host", peer1Host, 3),
+                R::getRequest("Top", top),
+                R::getRequest("Peer1", peer1)
+            });
+        } catch (Configuration::GetManyException const & e) {
+            thrown = true;
+            SHAREMIND_TESTASSERT(*e.what());
+            auto const & failures = e.failures();
+            SHAREMIND_TESTASSERT(failures.size() == 5u);
+            SHAREMIND_TESTASSERT(failures[0u].path.toString() == "Missing.Key");
+            SHAREMIND_TESTASSERT(
+                    isException<Configuration::ValueNotFoundException>(
+                        failures[0u].exception));
+            SHAREMIND_TESTASSERT(failures[1u].path.toString() == "Peer1");
+            SHAREMIND_TESTASSERT(
+                    isException<Configuration::ValueNotFoundException>(
+                        failures[1u].exception));
+            SHAREMIND_TESTASSERT(failures[2u].path.toString() == "Peer1.Host");
+            SHAREMIND_TESTASSERT(
+                    isException<Configuration::FailedToParseValueException>(
+                        failures[2u].exception));
+            SHAREMIND_TESTASSERT(
+                    failures[3u].path.toString() == "Peer1.Missing");
+            SHAREMIND_TESTASSERT(
+                    isException<Configuration::ValueNotFoundException>(
+                        failures[3u].exception));
+            SHAREMIND_TESTASSERT(failures[4u].path.toString() == "Peer2.Port");
+            SHAREMIND_TESTASSERT(
+                    isException<Configuration::FailedToParseValueException>(
+                        failures[4u].exception));
+
+            // Copies share the failures:
+            auto const copy(e);
+            SHAREMIND_TESTASSERT(&copy.failures() == &failures);
+        }
+        SHAREMIND_TESTASSERT(thrown);
+
+        // The other requests were still fulfilled:
+        SHAREMIND_TESTASSERT(peer2Host == "b.example");
+        SHAREMIND_TESTASSERT(top == 7);
+        SHAREMIND_TESTASSERT(peer1Host == 3);
+    }
+}
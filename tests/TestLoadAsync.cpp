@@ -0,0 +1,341 @@
+/*
+ * Copyright (C) 2017 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#include "../src/Configuration.h"
+#include "TemporaryDirectory.h"
+
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <exception>
+#include <fcntl.h>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <memory>
+#include <sharemind/TestAssert.h>
+#include <string>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+
+using sharemind::Configuration;
+using sharemind::TemporaryDirectory;
+
+namespace {
+
+using Flag = std::atomic<bool>;
+
+std::string directory;
+
+std::string writeFile(std::string const & name, std::string const & contents)
+{
+    auto const filename = directory + '/' + name;
+    std::ofstream f(filename, std::ios::binary);
+    f << contents;
+    SHAREMIND_TESTASSERT(f.good());
+    return filename;
+}
+
+template <typename E>
+bool isException(std::exception_ptr const & e) {
+    try {
+        std::rethrow_exception(e);
+    } catch (E const &) {
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+template <typename E>
+bool futureThrows(std::future<Configuration> future) {
+    try {
+        future.get();
+    } catch (E const &) {
+        return true;
+    } catch (...) {}
+    return false;
+}
+
+Configuration::LoadOptions cancellableOptions(
+        std::shared_ptr<Flag const> cancellationFlag)
+{
+    Configuration::LoadOptions options;
+    options.cancellationFlag = std::move(cancellationFlag);
+    return options;
+}
+
+/**
+  \brief Creates a named pipe and a thread writing the given number of
+         key-value lines into it, setting the flag after the given number of
+         lines. As the loader cannot read past the lines written before the
+         flag is set, this cancels loads at a predictable point.
+*/
+std::thread feedPipe(std::string const & name,
+                     unsigned const lines,
+                     unsigned const cancelAfter,
+                     std::shared_ptr<Flag> flag)
+{
+    auto const path = directory + '/' + name;
+    SHAREMIND_TESTASSERT(::mkfifo(path.c_str(), 0600) == 0);
+    return std::thread(
+                [path, lines, cancelAfter, flag]() {
+                    auto const fd = ::open(path.c_str(), O_WRONLY);
+                    SHAREMIND_TESTASSERT(fd >= 0);
+                    for (unsigned i = 0u; i < lines; ++i) {
+                        if (i == cancelAfter)
+                            flag->store(true);
+                        auto const line =
+                                "Key" + std::to_string(i) + " = 1\n";
+                        // Fails once the loader has closed the pipe:
+                        if (::write(fd, line.data(), line.size())
+                            != static_cast<::ssize_t>(line.size()))
+                            break;
+                    }
+                    if (cancelAfter == lines)
+                        flag->store(true);
+                    ::close(fd);
+                });
+}
+
+void checkLoaded(Configuration const & conf) {
+    SHAREMIND_TESTASSERT(conf.get<int>("Top") == 42);
+    SHAREMIND_TESTASSERT(conf.get<std::string>("Included.Name") == "inner");
+    auto const & timings = conf.loadTimings();
+    SHAREMIND_TESTASSERT(timings.total.count() > 0);
+    SHAREMIND_TESTASSERT(timings.total >= timings.open);
+    SHAREMIND_TESTASSERT(timings.total >= timings.read);
+    SHAREMIND_TESTASSERT(timings.total >= timings.parse);
+    SHAREMIND_TESTASSERT(timings.total >= timings.glob);
+    SHAREMIND_TESTASSERT(timings.total >= timings.index);
+}
+
+void runTests() {
+    auto const valid =
+            writeFile("valid.conf", "Top = 42\n@include included.conf\n");
+    writeFile("included.conf", "[Included]\nName = inner\n");
+    auto const invalid = writeFile("invalid.conf", "[Unterminated\n");
+    auto const missing = directory + "/missing.conf";
+    auto const interpolation =
+            std::make_shared<Configuration::Interpolation>();
+
+    auto const inlineExecutor =
+            [](std::function<void ()> task) { task(); };
+    std::vector<std::thread> threads;
+    auto const threadExecutor =
+            [&threads](std::function<void ()> task)
+            { threads.emplace_back(std::move(task)); };
+    std::vector<std::function<void ()> > queuedTasks;
+    auto const queueingExecutor =
+            [&queuedTasks](std::function<void ()> task)
+            { queuedTasks.emplace_back(std::move(task)); };
+    auto const runQueuedTasks =
+            [&queuedTasks]() {
+                for (auto & task : queuedTasks)
+                    task();
+                queuedTasks.clear();
+            };
+    auto const joinThreads =
+            [&threads]() {
+                for (auto & thread : threads)
+                    thread.join();
+                threads.clear();
+            };
+
+    // Futures:
+    for (auto const & executor
+            : {Configuration::Executor(inlineExecutor),
+               Configuration::Executor(threadExecutor)})
+    {
+        checkLoaded(Configuration::loadAsync(executor,
+                                             {missing, valid},
+                                             interpolation).get());
+        checkLoaded(Configuration::loadAsync(executor,
+                                             {valid},
+                                             interpolation,
+                                             Configuration::LoadOptions())
+                    .get());
+        SHAREMIND_TESTASSERT(
+                futureThrows<Configuration::NoValidConfigurationFileFound>(
+                    Configuration::loadAsync(executor,
+                                             {missing},
+                                             interpolation)));
+        SHAREMIND_TESTASSERT(
+                futureThrows<
+                    Configuration::FailedToOpenAndParseConfigurationException>(
+                        Configuration::loadAsync(executor,
+                                                 {invalid, valid},
+                                                 interpolation)));
+        SHAREMIND_TESTASSERT(
+                futureThrows<Configuration::NoTryPathsGivenException>(
+                    Configuration::loadAsync(executor, {}, interpolation)));
+        joinThreads();
+    }
+
+    // Callbacks:
+    for (auto const & executor
+            : {Configuration::Executor(inlineExecutor),
+               Configuration::Executor(threadExecutor)})
+    {
+        std::promise<Configuration> loaded;
+        Configuration::loadAsync(
+                    executor,
+                    {valid},
+                    interpolation,
+                    Configuration::LoadOptions(),
+                    [&loaded](Configuration * const conf,
+                              std::exception_ptr const error)
+                    {
+                        SHAREMIND_TESTASSERT(conf);
+                        SHAREMIND_TESTASSERT(!error);
+                        loaded.set_value(std::move(*conf));
+                    });
+        checkLoaded(loaded.get_future().get());
+
+        std::promise<std::exception_ptr> failed;
+        Configuration::loadAsync(
+                    executor,
+                    {invalid},
+                    interpolation,
+                    Configuration::LoadOptions(),
+                    [&failed](Configuration * const conf,
+                              std::exception_ptr error)
+                    {
+                        SHAREMIND_TESTASSERT(!conf);
+                        failed.set_value(std::move(error));
+                    });
+        SHAREMIND_TESTASSERT(
+                isException<
+                    Configuration::FailedToOpenAndParseConfigurationException>(
+                        failed.get_future().get()));
+        joinThreads();
+    }
+
+    // Cancelling before the task starts:
+    {
+        auto const flag = std::make_shared<Flag>(false);
+        auto future(Configuration::loadAsync(queueingExecutor,
+                                             {valid},
+                                             interpolation,
+                                             cancellableOptions(flag)));
+        std::exception_ptr callbackError;
+        bool callbackCalled = false;
+        Configuration::loadAsync(
+                    queueingExecutor,
+                    {valid},
+                    interpolation,
+                    cancellableOptions(flag),
+                    [&](Configuration * const conf, std::exception_ptr error) {
+                        SHAREMIND_TESTASSERT(!conf);
+                        callbackCalled = true;
+                        callbackError = std::move(error);
+                    });
+        SHAREMIND_TESTASSERT(queuedTasks.size() == 2u);
+        SHAREMIND_TESTASSERT(future.wait_for(std::chrono::seconds(0))
+                             == std::future_status::timeout);
+        flag->store(true);
+        runQueuedTasks();
+        SHAREMIND_TESTASSERT(
+                futureThrows<Configuration::LoadCancelledException>(
+                    std::move(future)));
+        SHAREMIND_TESTASSERT(callbackCalled);
+        SHAREMIND_TESTASSERT(
+                isException<Configuration::LoadCancelledException>(
+                    callbackError));
+
+        // A flag which is not set does not cancel anything:
+        flag->store(false);
+        checkLoaded(Configuration::loadAsync(inlineExecutor,
+                                             {valid},
+                                             interpolation,
+                                             cancellableOptions(flag)).get());
+    }
+
+    // Cancelling in the middle of a file, which is checked every 1024 lines:
+    {
+        auto const flag = std::make_shared<Flag>(false);
+        auto feeder(feedPipe("midParse.conf", 6000u, 1500u, flag));
+        auto future(Configuration::loadAsync(threadExecutor,
+                                             {directory + "/midParse.conf"},
+                                             interpolation,
+                                             cancellableOptions(flag)));
+        SHAREMIND_TESTASSERT(
+                futureThrows<Configuration::LoadCancelledException>(
+                    std::move(future)));
+        feeder.join();
+        joinThreads();
+    }
+
+    // Cancelling while parsing an included file, which is checked per file:
+    {
+        auto const flag = std::make_shared<Flag>(false);
+        auto feeder(feedPipe("includedPipe.conf", 10u, 10u, flag));
+        auto const including =
+                writeFile("including.conf",
+                          "Top = 42\n@include includedPipe.conf\nLast = 1\n");
+        std::promise<std::exception_ptr> failed;
+        Configuration::loadAsync(
+                    threadExecutor,
+                    {including},
+                    interpolation,
+                    cancellableOptions(flag),
+                    [&failed](Configuration * const conf,
+                              std::exception_ptr error)
+                    {
+                        SHAREMIND_TESTASSERT(!conf);
+                        failed.set_value(std::move(error));
+                    });
+        SHAREMIND_TESTASSERT(
+                isException<Configuration::LoadCancelledException>(
+                    failed.get_future().get()));
+        feeder.join();
+        joinThreads();
+    }
+}
+
+} // anonymous namespace
+
+int main() {
+    // Writes into pipes closed by cancelled loads must not kill the test:
+    std::signal(SIGPIPE, SIG_IGN);
+    int status;
+    {
+        TemporaryDirectory const temporaryDirectory("TestLoadAsync");
+        directory = temporaryDirectory.path();
+
+        /* Failed assertions abort the process, hence the tests are run in a
+           child process for the directory to be removed regardless: */
+        auto const pid = ::fork();
+        SHAREMIND_TESTASSERT(pid >= 0);
+        if (!pid) {
+            runTests();
+            ::_exit(EXIT_SUCCESS);
+        }
+        while (::waitpid(pid, &status, 0) != pid)
+            SHAREMIND_TESTASSERT(errno == EINTR);
+    }
+    SHAREMIND_TESTASSERT(WIFEXITED(status));
+    SHAREMIND_TESTASSERT(WEXITSTATUS(status) == EXIT_SUCCESS);
+}
@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) 2017 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#include "../src/Configuration.h"
+#include "TemporaryDirectory.h"
+
+#include <boost/filesystem/operations.hpp>
+#include <cerrno>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <sharemind/TestAssert.h>
+#include <string>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+
+using sharemind::Configuration;
+using sharemind::TemporaryDirectory;
+
+namespace {
+
+std::string directory;
+
+std::string writeFile(std::string const & name, std::string const & contents)
+{
+    auto const filename = directory + '/' + name;
+    std::ofstream f(filename, std::ios::binary);
+    f << contents;
+    SHAREMIND_TESTASSERT(f.good());
+    return filename;
+}
+
+void checkFile(Configuration::LoadedFileStatistics const & file,
+               std::string const & path,
+               std::uint64_t const bytes,
+               std::uint64_t const lines,
+               std::uint64_t const keys,
+               std::uint64_t const sections,
+               std::size_t const includeDepth)
+{
+    SHAREMIND_TESTASSERT(file.path == path);
+    SHAREMIND_TESTASSERT(file.bytes == bytes);
+    SHAREMIND_TESTASSERT(file.lines == lines);
+    SHAREMIND_TESTASSERT(file.keys == keys);
+    SHAREMIND_TESTASSERT(file.sections == sections);
+    SHAREMIND_TESTASSERT(file.includeDepth == includeDepth);
+}
+
+void runTests() {
+    std::string const mainContents("; A comment\n"
+                                   "Top = 1\n"
+                                   "@include sub/*.conf\n"
+                                   "[Main]\n"
+                                   "Key = 2\n");
+    std::string const aContents("[A]\n"
+                                "X = 1\n"
+                                "@include ../deep.conf\n");
+    std::string const bContents("[B]\n"
+                                "Y = 2\n"
+                                "Z = 3"); // No newline at the end
+    std::string const deepContents("[Deep]\n"
+                                   "W = 4\n"
+                                   "\n");
+    auto const main = writeFile("main.conf", mainContents);
+    SHAREMIND_TESTASSERT(::mkdir((directory + "/sub").c_str(), 0700) == 0);
+    writeFile("sub/b.conf", bContents);
+    writeFile("sub/a.conf", aContents);
+    writeFile("deep.conf", deepContents);
+
+    auto const interpolation =
+            std::make_shared<Configuration::Interpolation>();
+
+    // Nothing is collected by default:
+    {
+        Configuration const conf(main, interpolation);
+        auto const & statistics = conf.loadStatistics();
+        SHAREMIND_TESTASSERT(statistics.files.empty());
+        SHAREMIND_TESTASSERT(statistics.bytes == 0u);
+        SHAREMIND_TESTASSERT(statistics.lines == 0u);
+        SHAREMIND_TESTASSERT(statistics.keys == 0u);
+        SHAREMIND_TESTASSERT(statistics.sections == 0u);
+        SHAREMIND_TESTASSERT(statistics.includeDirectives == 0u);
+        SHAREMIND_TESTASSERT(statistics.maxIncludeDepth == 0u);
+    }
+
+    Configuration::LoadOptions options;
+    options.collectStatistics = true;
+    Configuration const conf(main, interpolation, options);
+    SHAREMIND_TESTASSERT(conf.get<int>("Deep.W") == 4);
+    auto const & statistics = conf.loadStatistics();
+
+    // The files in the order opened:
+    auto const canonical =
+            boost::filesystem::canonical(directory).string() + '/';
+    auto const & files = statistics.files;
+    SHAREMIND_TESTASSERT(files.size() == 4u);
+    checkFile(files[0u], canonical + "main.conf", mainContents.size(), 5u,
+              2u, 1u, 0u);
+    checkFile(files[1u], canonical + "sub/a.conf", aContents.size(), 3u,
+              1u, 1u, 1u);
+    checkFile(files[2u], canonical + "deep.conf", deepContents.size(), 3u,
+              1u, 1u, 2u);
+    checkFile(files[3u], canonical + "sub/b.conf", bContents.size(), 3u,
+              2u, 1u, 1u);
+
+    // The totals:
+    SHAREMIND_TESTASSERT(statistics.bytes
+                         == mainContents.size() + aContents.size()
+                            + bContents.size() + deepContents.size());
+    SHAREMIND_TESTASSERT(statistics.lines == 14u);
+    SHAREMIND_TESTASSERT(statistics.keys == 6u);
+    SHAREMIND_TESTASSERT(statistics.sections == 4u);
+    SHAREMIND_TESTASSERT(statistics.includeDirectives == 2u);
+    SHAREMIND_TESTASSERT(statistics.maxIncludeDepth == 2u);
+
+    // Copies keep the statistics:
+    Configuration const copy(conf);
+    SHAREMIND_TESTASSERT(copy.loadStatistics().files.size() == 4u);
+    SHAREMIND_TESTASSERT(copy.loadStatistics().keys == 6u);
+}
+
+} // anonymous namespace
+
+int main() {
+    int status;
+    {
+        TemporaryDirectory const temporaryDirectory("TestLoadStatistics");
+        directory = temporaryDirectory.path();
+
+        /* Failed assertions abort the process, hence the tests are run in a
+           child process for the directory to be removed regardless: */
+        auto const pid = ::fork();
+        SHAREMIND_TESTASSERT(pid >= 0);
+        if (!pid) {
+            runTests();
+            ::_exit(EXIT_SUCCESS);
+        }
+        while (::waitpid(pid, &status, 0) != pid)
+            SHAREMIND_TESTASSERT(errno == EINTR);
+    }
+    SHAREMIND_TESTASSERT(WIFEXITED(status));
+    SHAREMIND_TESTASSERT(WEXITSTATUS(status) == EXIT_SUCCESS);
+}
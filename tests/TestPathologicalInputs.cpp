@@ -0,0 +1,331 @@
+/*
+ * Copyright (C) 2017 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#include "../src/Configuration.h"
+#include "TemporaryDirectory.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <sharemind/TestAssert.h>
+#include <string>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+
+using sharemind::Configuration;
+using sharemind::TemporaryDirectory;
+
+namespace {
+
+/* Instrumentation by sanitizers slows the tests down considerably: */
+#if defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+constexpr unsigned const defaultTimeBudgetScale = 10u;
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer) || __has_feature(thread_sanitizer) \
+    || __has_feature(memory_sanitizer)
+constexpr unsigned const defaultTimeBudgetScale = 10u;
+#else
+constexpr unsigned const defaultTimeBudgetScale = 1u;
+#endif
+#else
+constexpr unsigned const defaultTimeBudgetScale = 1u;
+#endif
+
+/**
+  \returns the factor to multiply the time budgets with, which can be set with
+           the SHAREMIND_TEST_TIME_BUDGET_SCALE environment variable, e.g. on
+           heavily loaded machines.
+*/
+unsigned timeBudgetScale() {
+    if (auto const * const scale =
+                std::getenv("SHAREMIND_TEST_TIME_BUDGET_SCALE"))
+        if (auto const value = std::strtoul(scale, nullptr, 10))
+            return static_cast<unsigned>(value);
+    return defaultTimeBudgetScale;
+}
+
+std::string directory;
+
+std::string writeFile(std::string const & name, std::string const & contents)
+{
+    auto const filename = directory + '/' + name;
+    std::ofstream f(filename, std::ios::binary);
+    f << contents;
+    SHAREMIND_TESTASSERT(f.good());
+    return filename;
+}
+
+/**
+  \brief Runs f() in a child process, checking that it succeeds within the
+         given time and grows the peak resident set size of the process by
+         at most the given amount.
+  \note The budgets are generous to allow for slow builds, so that only
+        super-linear behaviour exceeds them. The time budgets are scaled by
+        timeBudgetScale().
+*/
+template <typename F>
+void testWithinBudget(char const * const name,
+                      std::chrono::milliseconds const timeBudget,
+                      long const memoryBudgetKiB,
+                      F && f)
+{
+    auto const pid = ::fork();
+    SHAREMIND_TESTASSERT(pid >= 0);
+    if (!pid) {
+        ::rusage usage;
+        SHAREMIND_TESTASSERT(::getrusage(RUSAGE_SELF, &usage) == 0);
+        auto const rssBefore = usage.ru_maxrss;
+        auto const start = std::chrono::steady_clock::now();
+        f();
+        auto const elapsed =
+                std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - start);
+        SHAREMIND_TESTASSERT(::getrusage(RUSAGE_SELF, &usage) == 0);
+        auto const rssGrowth = usage.ru_maxrss - rssBefore;
+        std::fprintf(stderr,
+                     "%s: %lld ms, %ld KiB\n",
+                     name,
+                     static_cast<long long>(elapsed.count()),
+                     rssGrowth);
+        SHAREMIND_TESTASSERT(elapsed <= timeBudget * timeBudgetScale());
+        SHAREMIND_TESTASSERT(rssGrowth <= memoryBudgetKiB);
+        ::_exit(EXIT_SUCCESS);
+    }
+    int status;
+    SHAREMIND_TESTASSERT(::waitpid(pid, &status, 0) == pid);
+    SHAREMIND_TESTASSERT(WIFEXITED(status));
+    SHAREMIND_TESTASSERT(WEXITSTATUS(status) == EXIT_SUCCESS);
+}
+
+/** \returns whether e is or has nested an exception of type E. */
+template <typename E>
+bool hasNested(std::exception_ptr e) {
+    while (e) {
+        try {
+            std::rethrow_exception(e);
+        } catch (E const &) {
+            return true;
+        } catch (std::nested_exception const & nested) {
+            e = nested.nested_ptr();
+        } catch (...) {
+            return false;
+        }
+    }
+    return false;
+}
+
+template <typename E>
+void testLoadFails(std::string const & filename,
+                   Configuration::LoadOptions const & options)
+{
+    std::exception_ptr e;
+    try {
+        Configuration const conf(
+                    filename,
+                    std::make_shared<Configuration::Interpolation>(),
+                    options);
+    } catch (...) {
+        e = std::current_exception();
+    }
+    SHAREMIND_TESTASSERT(hasNested<E>(e));
+}
+
+Configuration load(std::string const & filename) { return {filename}; }
+
+void runTests() {
+    using std::chrono::milliseconds;
+
+    // A single line of 16 MiB:
+    auto const longLine =
+            writeFile("longLine.conf",
+                      "[S]\nKey = " + std::string(16u << 20u, 'x') + '\n');
+    testWithinBudget("long line", milliseconds(5000), 256 * 1024, [&] {
+        SHAREMIND_TESTASSERT(
+                load(longLine).getView("S.Key").size() == (16u << 20u));
+    });
+    testWithinBudget("long line limit", milliseconds(5000), 64 * 1024, [&] {
+        Configuration::LoadOptions options;
+        options.maxLineLength = 4096u;
+        testLoadFails<Configuration::LineTooLongException>(longLine, options);
+    });
+    testWithinBudget("file size limit", milliseconds(5000), 64 * 1024, [&] {
+        Configuration::LoadOptions options;
+        options.maxFileSize = 1u << 20u;
+        testLoadFails<Configuration::FileTooLargeException>(longLine, options);
+    });
+
+    // Read errors are reported alike with and without a line length limit:
+    {
+        Configuration::LoadOptions options;
+        testLoadFails<Configuration::FileReadException>(directory, options);
+        options.maxLineLength = 4096u;
+        testLoadFails<Configuration::FileReadException>(directory, options);
+    }
+
+    // Values full of escapes which are processed while loading:
+    {
+        std::string value;
+        for (unsigned i = 0u; i < 100000u; ++i)
+            value.append("%%%{CurrentFileDirectory}%{Var}");
+        auto const escapes = writeFile("escapes.conf", "Key = " + value + '\n');
+        testWithinBudget("escapes", milliseconds(5000), 256 * 1024, [&] {
+            SHAREMIND_TESTASSERT(load(escapes).hasValue("Key"));
+        });
+    }
+
+    // Many sibling keys and sections, with a duplicate key at the end:
+    {
+        std::string contents("[Wide]\n");
+        for (unsigned i = 0u; i < 200000u; ++i)
+            contents.append("Key").append(std::to_string(i)).append(" = 1\n");
+        for (unsigned i = 0u; i < 50000u; ++i)
+            contents.append("[Section").append(std::to_string(i)).append("]\n");
+        auto const wide = writeFile("wide.conf", contents);
+        testWithinBudget("wide", milliseconds(10000), 512 * 1024, [&] {
+            auto conf(load(wide));
+            SHAREMIND_TESTASSERT(conf.section("Wide").size() == 200000u);
+            SHAREMIND_TESTASSERT(conf.size() == 50001u);
+
+            // Lookups, iteration order and erasure in the wide section:
+            unsigned i = 0u;
+            for (auto const child : conf.section("Wide"))
+                SHAREMIND_TESTASSERT(
+                        child.key() == "Key" + std::to_string(i++));
+            for (i = 0u; i < 200000u; ++i)
+                SHAREMIND_TESTASSERT(
+                        conf.get<int>("Wide.Key" + std::to_string(i)) == 1);
+            SHAREMIND_TESTASSERT(!conf.hasValue("Wide.Key200000"));
+            SHAREMIND_TESTASSERT(conf.hasSection("Section49999"));
+            auto const view(conf.view());
+            for (i = 0u; i < 50000u; ++i) {
+                auto const key("Section" + std::to_string(i));
+                SHAREMIND_TESTASSERT(view.section(key).key() == key);
+            }
+            for (i = 0u; i < 200000u; i += 100u)
+                conf.erase("Wide.Key" + std::to_string(i + 5u));
+            SHAREMIND_TESTASSERT(!conf.hasValue("Wide.Key5"));
+            SHAREMIND_TESTASSERT(!conf.hasValue("Wide.Key199905"));
+            SHAREMIND_TESTASSERT(conf.get<int>("Wide.Key6") == 1);
+            SHAREMIND_TESTASSERT(conf.get<int>("Wide.Key199999") == 1);
+            SHAREMIND_TESTASSERT(conf.section("Wide").size() == 198000u);
+        });
+        contents.append("[Wide]\nKey0 = 2\n");
+        auto const duplicate = writeFile("duplicate.conf", contents);
+        testWithinBudget("duplicate", milliseconds(10000), 512 * 1024, [&] {
+            testLoadFails<Configuration::DuplicateKeyException>(
+                        duplicate,
+                        Configuration::LoadOptions());
+        });
+    }
+
+    // A chain of 1000 files, each including the next:
+    {
+        constexpr unsigned depth = 1000u;
+        for (unsigned i = 0u; i < depth; ++i) {
+            std::string contents("[Level" + std::to_string(i) + "]\nKey = 1\n");
+            if (i + 1u < depth)
+                contents.append("@include chain")
+                        .append(std::to_string(i + 1u))
+                        .append(".conf\n");
+            writeFile("chain" + std::to_string(i) + ".conf", contents);
+        }
+        auto const chain = directory + "/chain0.conf";
+        testWithinBudget("include chain", milliseconds(5000), 64 * 1024, [&] {
+            SHAREMIND_TESTASSERT(load(chain).size() == depth);
+        });
+        testWithinBudget("include depth limit", milliseconds(5000), 64 * 1024,
+                         [&] {
+            Configuration::LoadOptions options;
+            options.maxIncludeDepth = 10u;
+            testLoadFails<Configuration::IncludeTooDeepException>(chain,
+                                                                  options);
+            options.maxIncludeDepth = depth - 1u;
+            SHAREMIND_TESTASSERT(
+                        Configuration(
+                            chain,
+                            std::make_shared<Configuration::Interpolation>(),
+                            options).size() == depth);
+        });
+        testWithinBudget("included files limit", milliseconds(5000), 64 * 1024,
+                         [&] {
+            Configuration::LoadOptions options;
+            options.maxIncludedFiles = 100u;
+            testLoadFails<Configuration::TooManyIncludedFilesException>(
+                        chain,
+                        options);
+        });
+    }
+
+    // Many files included by a single directive:
+    {
+        SHAREMIND_TESTASSERT(
+                ::mkdir((directory + "/many").c_str(), 0700) == 0);
+        for (unsigned i = 0u; i < 2000u; ++i)
+            writeFile("many/" + std::to_string(i) + ".conf",
+                      "[File" + std::to_string(i) + "]\nKey = 1\n");
+        auto const many = writeFile("many.conf", "@include many/*.conf\n");
+        testWithinBudget("many included files", milliseconds(5000), 64 * 1024,
+                         [&] {
+            Configuration::LoadOptions options;
+            options.maxIncludedFiles = 1000u;
+            testLoadFails<Configuration::TooManyIncludedFilesException>(
+                        many,
+                        options);
+            options.maxIncludedFiles = 2000u;
+            options.useIoUring = true;
+            options.maxFileSize = 64u;
+            SHAREMIND_TESTASSERT(
+                        Configuration(
+                            many,
+                            std::make_shared<Configuration::Interpolation>(),
+                            options).size() == 2000u);
+            options.maxFileSize = 8u;
+            testLoadFails<Configuration::FileTooLargeException>(many, options);
+        });
+    }
+}
+
+} // anonymous namespace
+
+int main() {
+    int status;
+    {
+        TemporaryDirectory const temporaryDirectory("TestPathologicalInputs");
+        directory = temporaryDirectory.path();
+
+        /* Failed assertions abort the process, hence the tests are run in a
+           child process for the directory to be removed regardless: */
+        auto const pid = ::fork();
+        SHAREMIND_TESTASSERT(pid >= 0);
+        if (!pid) {
+            runTests();
+            ::_exit(EXIT_SUCCESS);
+        }
+        while (::waitpid(pid, &status, 0) != pid)
+            SHAREMIND_TESTASSERT(errno == EINTR);
+    }
+    SHAREMIND_TESTASSERT(WIFEXITED(status));
+    SHAREMIND_TESTASSERT(WEXITSTATUS(status) == EXIT_SUCCESS);
+}
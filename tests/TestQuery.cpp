@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2017 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#include "../src/Configuration.h"
+
+#include <fstream>
+#include <sharemind/TestAssert.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+
+using sharemind::Configuration;
+
+namespace {
+
+std::vector<std::string> matchedPaths(Configuration const & conf,
+                                      char const * const pattern)
+{
+    std::vector<std::string> r;
+    for (auto const & match : conf.query(pattern))
+        r.emplace_back(match.path().toString());
+    return r;
+}
+
+} // anonymous namespace
+
+int main() {
+    char filename[] = "/tmp/TestQuery.XXXXXX";
+    {
+        auto const fd = ::mkstemp(filename);
+        SHAREMIND_TESTASSERT(fd >= 0);
+        ::close(fd);
+        std::ofstream f(filename);
+        f << "Enabled = yes\n"
+             "Port = 1\n"
+             "[Peer2]\nEnabled = no\nPort = 2000\n"
+             "[Peer1]\nPort = 1000\nHost = a.example\n"
+             "[Peer10]\nPort = 3000\n"
+             "[Server]\nEnabled = yes\nName = server\n";
+    }
+    Configuration const conf(filename);
+    ::unlink(filename);
+
+    using V = std::vector<std::string>;
+    auto const structureBefore = conf.memoryUsage().structure;
+
+    // Components without a literal prefix visit keys in declaration order:
+    SHAREMIND_TESTASSERT(matchedPaths(conf, "*.Enabled")
+                         == (V{"Peer2.Enabled", "Server.Enabled"}));
+    SHAREMIND_TESTASSERT(matchedPaths(conf, "?ort") == V{"Port"});
+    SHAREMIND_TESTASSERT(matchedPaths(conf, "*.?ame") == V{"Server.Name"});
+
+    // "**" matches zero or more levels:
+    SHAREMIND_TESTASSERT(
+            matchedPaths(conf, "**.Enabled")
+            == (V{"Enabled", "Peer2.Enabled", "Server.Enabled"}));
+    SHAREMIND_TESTASSERT(
+            matchedPaths(conf, "**")
+            == (V{"Enabled", "Port",
+                  "Peer2", "Peer2.Enabled", "Peer2.Port",
+                  "Peer1", "Peer1.Port", "Peer1.Host",
+                  "Peer10", "Peer10.Port",
+                  "Server", "Server.Enabled", "Server.Name"}));
+    SHAREMIND_TESTASSERT(matchedPaths(conf, "**.Peer1.Host")
+                         == V{"Peer1.Host"});
+
+    // Nodes reachable in several ways are matched only once:
+    SHAREMIND_TESTASSERT(
+            matchedPaths(conf, "**.**.Port")
+            == (V{"Port", "Peer2.Port", "Peer1.Port", "Peer10.Port"}));
+    SHAREMIND_TESTASSERT(matchedPaths(conf, "**.*.**").size() == 13u);
+
+    // Patterns without a literal prefix do not build the sorted indexes:
+    SHAREMIND_TESTASSERT(conf.memoryUsage().structure == structureBefore);
+
+    // Components with a literal prefix visit keys in key order:
+    SHAREMIND_TESTASSERT(
+            matchedPaths(conf, "Peer*.Port")
+            == (V{"Peer1.Port", "Peer10.Port", "Peer2.Port"}));
+    SHAREMIND_TESTASSERT(matchedPaths(conf, "Peer?.Port")
+                         == (V{"Peer1.Port", "Peer2.Port"}));
+    SHAREMIND_TESTASSERT(conf.memoryUsage().structure > structureBefore);
+
+    // Literal components and no matches:
+    SHAREMIND_TESTASSERT(matchedPaths(conf, "Peer1.Port") == V{"Peer1.Port"});
+    SHAREMIND_TESTASSERT(matchedPaths(conf, "Peer3.*").empty());
+    SHAREMIND_TESTASSERT(matchedPaths(conf, "Port.*").empty());
+    SHAREMIND_TESTASSERT(matchedPaths(conf, "Peer*.Port.**.X").empty());
+
+    // Matches refer to the matched nodes and are relative to the section:
+    auto const matches(conf.section("Peer1").query("*"));
+    SHAREMIND_TESTASSERT(matches.size() == 2u);
+    SHAREMIND_TESTASSERT(matches[0u].path().toString() == "Peer1.Port");
+    SHAREMIND_TESTASSERT(matches[0u].key() == "Port");
+    SHAREMIND_TESTASSERT(matches[0u].value<int>() == 1000);
+    SHAREMIND_TESTASSERT(matches[1u].configuration().value<std::string>()
+                         == "a.example");
+    SHAREMIND_TESTASSERT(conf.query("Peer*").front().get<int>("Port") == 1000);
+}
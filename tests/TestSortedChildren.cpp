@@ -0,0 +1,137 @@
+/*
+ * Copyright (C) 2017 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#include "../src/Configuration.h"
+
+#include <fstream>
+#include <sharemind/TestAssert.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+
+using sharemind::Configuration;
+
+namespace {
+
+using Keys = std::vector<std::string>;
+
+template <typename Range>
+Keys keysOf(Range const & range) {
+    Keys r;
+    for (auto const child : range)
+        r.emplace_back(child.key());
+    return r;
+}
+
+} // anonymous namespace
+
+int main() {
+    char filename[] = "/tmp/TestSortedChildren.XXXXXX";
+    {
+        auto const fd = ::mkstemp(filename);
+        SHAREMIND_TESTASSERT(fd >= 0);
+        ::close(fd);
+        std::ofstream f(filename);
+        f << "Gamma = 3\n"
+             "Alpha = 1\n"
+             "Both = value\n"
+             "Beta = 2\n"
+             "[Both]\nInner = 4\n"
+             "[Empty]\n"
+             "[Beta2]\nX = 5\nB = 6\nA = 7\n";
+    }
+    Configuration conf(filename);
+    ::unlink(filename);
+
+    // Prefixes:
+    SHAREMIND_TESTASSERT(
+            keysOf(conf.childrenWithPrefix(""))
+            == (Keys{"Alpha", "Beta", "Beta2", "Both", "Empty", "Gamma"}));
+    SHAREMIND_TESTASSERT(keysOf(conf.childrenWithPrefix("B"))
+                         == (Keys{"Beta", "Beta2", "Both"}));
+    SHAREMIND_TESTASSERT(keysOf(conf.childrenWithPrefix("Beta"))
+                         == (Keys{"Beta", "Beta2"}));
+    SHAREMIND_TESTASSERT(keysOf(conf.childrenWithPrefix("Beta2"))
+                         == Keys{"Beta2"});
+    SHAREMIND_TESTASSERT(conf.childrenWithPrefix("Beta22").empty());
+    SHAREMIND_TESTASSERT(conf.childrenWithPrefix("Bz").empty());
+    SHAREMIND_TESTASSERT(conf.childrenWithPrefix("A ").empty());
+    SHAREMIND_TESTASSERT(conf.childrenWithPrefix("Zeta").empty());
+    SHAREMIND_TESTASSERT(conf.section("Empty").childrenWithPrefix("").empty());
+    SHAREMIND_TESTASSERT(keysOf(conf.section("Beta2").childrenWithPrefix(""))
+                         == (Keys{"A", "B", "X"}));
+
+    // Sections, including keys which are both values and sections:
+    SHAREMIND_TESTASSERT(keysOf(conf.sectionsWithPrefix(""))
+                         == (Keys{"Beta2", "Both", "Empty"}));
+    SHAREMIND_TESTASSERT(keysOf(conf.sectionsWithPrefix("B"))
+                         == (Keys{"Beta2", "Both"}));
+    SHAREMIND_TESTASSERT(conf.sectionsWithPrefix("A").empty());
+    SHAREMIND_TESTASSERT(conf.sectionsWithPrefix("Gamma").empty());
+    for (auto const child : conf.childrenWithPrefix("Both")) {
+        SHAREMIND_TESTASSERT(child.hasValue());
+        SHAREMIND_TESTASSERT(child.hasSection());
+        SHAREMIND_TESTASSERT(child.value<std::string>() == "value");
+        SHAREMIND_TESTASSERT(child.get<int>("Inner") == 4);
+        SHAREMIND_TESTASSERT(child.path().toString() == "Both");
+    }
+    for (auto const child : conf.section("Beta2").childrenWithPrefix("X")) {
+        SHAREMIND_TESTASSERT(child.path().toString() == "Beta2.X");
+        SHAREMIND_TESTASSERT(child.configuration().value<int>() == 5);
+    }
+
+    // Half-open ranges:
+    SHAREMIND_TESTASSERT(keysOf(conf.childrenInRange("Beta", "Both"))
+                         == (Keys{"Beta", "Beta2"}));
+    SHAREMIND_TESTASSERT(keysOf(conf.childrenInRange("Beta2", "Gamma"))
+                         == (Keys{"Beta2", "Both", "Empty"}));
+    SHAREMIND_TESTASSERT(keysOf(conf.childrenInRange("Alpha", "Alphb"))
+                         == Keys{"Alpha"});
+    SHAREMIND_TESTASSERT(keysOf(conf.childrenInRange("B", "C"))
+                         == (Keys{"Beta", "Beta2", "Both"}));
+    SHAREMIND_TESTASSERT(keysOf(conf.childrenInRange("", "\x7f")).size()
+                         == 6u);
+    SHAREMIND_TESTASSERT(conf.childrenInRange("A", "Alpha").empty());
+    SHAREMIND_TESTASSERT(conf.childrenInRange("Gamma", "Gamma").empty());
+    SHAREMIND_TESTASSERT(conf.childrenInRange("Gamma", "Beta").empty());
+    SHAREMIND_TESTASSERT(conf.childrenInRange("H", "Z").empty());
+
+    // Erasures update the built indexes:
+    conf.erase("Beta2");
+    SHAREMIND_TESTASSERT(keysOf(conf.childrenWithPrefix("Beta"))
+                         == Keys{"Beta"});
+    SHAREMIND_TESTASSERT(keysOf(conf.sectionsWithPrefix("B"))
+                         == Keys{"Both"});
+    conf.eraseSection("Both");
+    SHAREMIND_TESTASSERT(keysOf(conf.childrenWithPrefix("B"))
+                         == (Keys{"Beta", "Both"}));
+    SHAREMIND_TESTASSERT(conf.sectionsWithPrefix("B").empty());
+    conf.eraseValue("Gamma");
+    conf.erase("Missing");
+    SHAREMIND_TESTASSERT(keysOf(conf.childrenInRange("", "\x7f"))
+                         == (Keys{"Alpha", "Beta", "Both", "Empty"}));
+    conf.erase("Alpha");
+    conf.erase("Beta");
+    conf.erase("Both");
+    conf.erase("Empty");
+    SHAREMIND_TESTASSERT(conf.childrenWithPrefix("").empty());
+    SHAREMIND_TESTASSERT(conf.sectionsWithPrefix("").empty());
+    SHAREMIND_TESTASSERT(conf.empty());
+}
@@ -0,0 +1,212 @@
+/*
+ * Copyright (C) 2017 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#include "../src/Configuration.h"
+
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <sharemind/TestAssert.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+
+using sharemind::ByteSize;
+using sharemind::Configuration;
+
+namespace {
+
+using Failures = std::vector<Configuration::ValidationException::Failure>;
+
+template <typename ... Args>
+Failures validationFailures(Configuration const & conf, Args && ... args) {
+    try {
+        conf.validate(std::forward<Args>(args)...);
+    } catch (Configuration::ValidationException const & e) {
+        return e.failures();
+    }
+    return Failures();
+}
+
+template <typename E>
+bool isException(std::exception_ptr const & e) {
+    try {
+        std::rethrow_exception(e);
+    } catch (E const &) {
+        return true;
+    } catch (...) {
+        return false;
+    }
+}
+
+} // anonymous namespace
+
+int main() {
+    char filename[] = "/tmp/TestValidation.XXXXXX";
+    {
+        auto const fd = ::mkstemp(filename);
+        SHAREMIND_TESTASSERT(fd >= 0);
+        ::close(fd);
+        std::ofstream f(filename);
+        f << "[Peer1]\n"
+             "Port = 1000\n"
+             "Buffer = 64 MiB\n"
+             "[Peer2]\n"
+             "Port = 70000\n"
+             "Buffer = 1 KiB\n"
+             "[Peer3]\n"
+             "Port = many\n"
+             "Buffer = %{Unknown}\n"
+             "[Server]\n"
+             "Timeout = 1500 ms\n"
+             "Name = server\n";
+        for (unsigned i = 0u; i < 1000u; ++i)
+            f << "Key" << i << " = " << i << '\n';
+    }
+    Configuration conf(filename);
+    ::unlink(filename);
+
+    using R = Configuration;
+    std::vector<Configuration::ValidationRule> const validRules{
+        R::validationRule<std::uint16_t>("Peer1.Port"),
+        R::rangeValidationRule<ByteSize>("Peer1.Buffer",
+                                         ByteSize(1024u),
+                                         ByteSize(1024u * 1024u * 1024u)),
+        R::validationRule<std::chrono::milliseconds>("Server.Timeout"),
+        R::validationRule<std::string>(
+                    "Server.Name",
+                    std::function<bool (std::string const &)>(
+                        [](std::string const & name)
+                        { return !name.empty(); })),
+        R::rangeValidationRule<unsigned>("Server.Key*", 0u, 999u),
+        R::validationRule<int>("Client.Port", false)
+    };
+
+    // Valid values, validated in the calling thread only:
+    conf.validate(validRules,
+                  [](std::function<void ()>) { SHAREMIND_TESTASSERT(false); },
+                  1u);
+
+    // The parsed values are cached only if caching is enabled:
+    auto const valuesBefore = conf.memoryUsage().values;
+    auto const inline_ = [](std::function<void ()> task) { task(); };
+    conf.validate(validRules, inline_, 4u);
+    SHAREMIND_TESTASSERT(conf.memoryUsage().values == valuesBefore);
+    conf.setParsedValueCaching(true);
+    conf.validate(validRules, inline_, 4u);
+    auto const valuesCached = conf.memoryUsage().values;
+    SHAREMIND_TESTASSERT(valuesCached > valuesBefore);
+    conf.validate(validRules, inline_, 4u);
+    SHAREMIND_TESTASSERT(conf.memoryUsage().values == valuesCached);
+    conf.setParsedValueCaching(false);
+
+    // Invalid values, reported together in the order of the rules:
+    std::vector<Configuration::ValidationRule> const invalidRules{
+        R::validationRule<std::uint16_t>("Peer*.Port"),
+        R::rangeValidationRule<ByteSize>("Peer*.Buffer",
+                                         ByteSize(4096u),
+                                         ByteSize(1024u * 1024u * 1024u)),
+        R::validationRule<int>("Client.Port"),
+        R::validationRule<int>("Server")
+    };
+    auto const checkFailures =
+            [](Failures const & failures) {
+                SHAREMIND_TESTASSERT(failures.size() == 6u);
+                SHAREMIND_TESTASSERT(failures[0u].path.toString()
+                                     == "Peer2.Port");
+                SHAREMIND_TESTASSERT(failures[0u].lineNumber == 5u);
+                SHAREMIND_TESTASSERT(isException<
+                        Configuration::FailedToParseValueException>(
+                            failures[0u].exception));
+                SHAREMIND_TESTASSERT(isException<std::nested_exception>(
+                                         failures[0u].exception));
+                SHAREMIND_TESTASSERT(failures[1u].path.toString()
+                                     == "Peer3.Port");
+                SHAREMIND_TESTASSERT(failures[1u].lineNumber == 8u);
+                SHAREMIND_TESTASSERT(failures[2u].path.toString()
+                                     == "Peer2.Buffer");
+                SHAREMIND_TESTASSERT(failures[2u].lineNumber == 6u);
+                SHAREMIND_TESTASSERT(isException<
+                        Configuration::InvalidValueException>(
+                            failures[2u].exception));
+                SHAREMIND_TESTASSERT(failures[3u].path.toString()
+                                     == "Peer3.Buffer");
+                SHAREMIND_TESTASSERT(failures[3u].lineNumber == 9u);
+                SHAREMIND_TESTASSERT(isException<
+                        Configuration::InterpolationException>(
+                            failures[3u].exception));
+                SHAREMIND_TESTASSERT(failures[4u].path.toString()
+                                     == "Client.Port");
+                SHAREMIND_TESTASSERT(failures[4u].filename.empty());
+                SHAREMIND_TESTASSERT(isException<
+                        Configuration::ValueNotFoundException>(
+                            failures[4u].exception));
+                SHAREMIND_TESTASSERT(failures[5u].path.toString()
+                                     == "Server");
+                SHAREMIND_TESTASSERT(isException<
+                        Configuration::ValueNotFoundException>(
+                            failures[5u].exception));
+                for (std::size_t i = 0u; i < 4u; ++i)
+                    SHAREMIND_TESTASSERT(failures[i].filename.find(
+                                             "TestValidation.")
+                                         != std::string::npos);
+            };
+    checkFailures(validationFailures(conf, invalidRules));
+    checkFailures(validationFailures(conf, invalidRules, inline_, 3u));
+
+    /* With enough values to validate for the executor to be used, tasks
+       started by the executor after validation has completed: */
+    auto manyInvalidRules(invalidRules);
+    manyInvalidRules.emplace_back(R::validationRule<unsigned>("Server.Key*"));
+    std::vector<std::function<void ()> > lateTasks;
+    checkFailures(validationFailures(
+                      conf,
+                      manyInvalidRules,
+                      [&lateTasks](std::function<void ()> task)
+                      { lateTasks.emplace_back(std::move(task)); },
+                      8u));
+    SHAREMIND_TESTASSERT(lateTasks.size() == 7u);
+    for (auto & task : lateTasks)
+        task();
+
+    // An executor which fails to run tasks:
+    std::size_t executorCalls = 0u;
+    checkFailures(validationFailures(
+                      conf,
+                      manyInvalidRules,
+                      [&executorCalls](std::function<void ()>) {
+                          ++executorCalls;
+                          throw std::bad_alloc();
+                      },
+                      8u));
+    SHAREMIND_TESTASSERT(executorCalls == 1u);
+
+    // Many values validated by many threads:
+    std::vector<Configuration::ValidationRule> manyRules;
+    for (unsigned i = 0u; i < 100u; ++i)
+        manyRules.emplace_back(
+                    R::rangeValidationRule<int>("Server.Key*", 1, 999));
+    auto const failures(validationFailures(conf, manyRules));
+    SHAREMIND_TESTASSERT(failures.size() == 100u);
+    for (auto const & failure : failures)
+        SHAREMIND_TESTASSERT(failure.path.toString() == "Server.Key0");
+}
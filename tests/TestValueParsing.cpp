@@ -0,0 +1,275 @@
+/*
+ * Copyright (C) 2017 Cybernetica
+ *
+ * Research/Commercial License Usage
+ * Licensees holding a valid Research License or Commercial License
+ * for the Software may use this file according to the written
+ * agreement between you and Cybernetica.
+ *
+ * GNU General Public License Usage
+ * Alternatively, this file may be used under the terms of the GNU
+ * General Public License version 3.0 as published by the Free Software
+ * Foundation and appearing in the file LICENSE.GPL included in the
+ * packaging of this file.  Please review the following information to
+ * ensure the GNU General Public License version 3.0 requirements will be
+ * met: http://www.gnu.org/copyleft/gpl-3.0.html.
+ *
+ * For further information, please contact us at sharemind@cyber.ee.
+ */
+
+#include "../src/Configuration.h"
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <sharemind/TestAssert.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+
+using sharemind::ByteSize;
+using sharemind::Configuration;
+
+namespace {
+
+Configuration const * conf;
+
+template <typename T>
+bool parsesTo(char const * const path, T const & expected) {
+    auto const r(conf->tryGet<T>(path));
+    return r && (*r == expected);
+}
+
+template <typename T>
+bool failsToParse(char const * const path) {
+    return conf->tryGet<T>(path).error()
+           == Configuration::GetError::ParseFailed;
+}
+
+void testByteSizes() {
+    constexpr std::uint64_t const ki = 1024u;
+    auto const bytes = [](std::uint64_t const n) { return ByteSize(n); };
+
+    // Binary and decimal suffixes:
+    SHAREMIND_TESTASSERT(parsesTo("Bytes.Plain", bytes(5u)));
+    SHAREMIND_TESTASSERT(parsesTo("Bytes.B", bytes(5u)));
+    SHAREMIND_TESTASSERT(parsesTo("Bytes.K", bytes(ki)));
+    SHAREMIND_TESTASSERT(parsesTo("Bytes.KiB", bytes(ki)));
+    SHAREMIND_TESTASSERT(parsesTo("Bytes.kB", bytes(1000u)));
+    SHAREMIND_TESTASSERT(parsesTo("Bytes.KB", bytes(1000u)));
+    SHAREMIND_TESTASSERT(parsesTo("Bytes.MiB", bytes(64u * ki * ki)));
+    SHAREMIND_TESTASSERT(parsesTo("Bytes.MB", bytes(64000000u)));
+    SHAREMIND_TESTASSERT(parsesTo("Bytes.GiB", bytes(3u * ki * ki * ki)));
+    SHAREMIND_TESTASSERT(parsesTo("Bytes.TB", bytes(2000000000000u)));
+
+    // Whitespace between the number and the suffix:
+    SHAREMIND_TESTASSERT(parsesTo("Bytes.Spaces", bytes(64u * ki * ki)));
+    SHAREMIND_TESTASSERT(parsesTo("Bytes.Tab", bytes(64u * ki)));
+    SHAREMIND_TESTASSERT(parsesTo("Bytes.NoSpace", bytes(64u * ki * ki)));
+
+    // The limits of 64-bit sizes:
+    SHAREMIND_TESTASSERT(parsesTo("Bytes.Max", bytes(UINT64_MAX)));
+    SHAREMIND_TESTASSERT(parsesTo("Bytes.MaxEiB", bytes(15u * (ki << 50u))));
+    SHAREMIND_TESTASSERT(
+            parsesTo("Bytes.MaxEB", bytes(18000000000000000000u)));
+    SHAREMIND_TESTASSERT(failsToParse<ByteSize>("Bytes.AboveMax"));
+    SHAREMIND_TESTASSERT(failsToParse<ByteSize>("Bytes.OverflowEiB"));
+    SHAREMIND_TESTASSERT(failsToParse<ByteSize>("Bytes.OverflowEB"));
+
+    // Invalid sizes:
+    SHAREMIND_TESTASSERT(failsToParse<ByteSize>("Bytes.Negative"));
+    SHAREMIND_TESTASSERT(failsToParse<ByteSize>("Bytes.Fractional"));
+    SHAREMIND_TESTASSERT(failsToParse<ByteSize>("Bytes.OnlySuffix"));
+    SHAREMIND_TESTASSERT(failsToParse<ByteSize>("Bytes.LowerCase"));
+    SHAREMIND_TESTASSERT(failsToParse<ByteSize>("Bytes.Unknown"));
+    SHAREMIND_TESTASSERT(failsToParse<ByteSize>("Bytes.SplitSuffix"));
+    SHAREMIND_TESTASSERT(failsToParse<ByteSize>("Bytes.Empty"));
+}
+
+void testDurations() {
+    using std::chrono::hours;
+    using std::chrono::microseconds;
+    using std::chrono::milliseconds;
+    using std::chrono::minutes;
+    using std::chrono::nanoseconds;
+    using std::chrono::seconds;
+
+    // Units, defaulting to that of the type:
+    SHAREMIND_TESTASSERT(parsesTo("Durations.Plain", milliseconds(5)));
+    SHAREMIND_TESTASSERT(parsesTo("Durations.Plain", hours(5)));
+    SHAREMIND_TESTASSERT(parsesTo("Durations.ms", milliseconds(1500)));
+    SHAREMIND_TESTASSERT(parsesTo("Durations.ms", microseconds(1500000)));
+    SHAREMIND_TESTASSERT(parsesTo("Durations.s", milliseconds(2000)));
+    SHAREMIND_TESTASSERT(parsesTo("Durations.min", seconds(5400)));
+    SHAREMIND_TESTASSERT(parsesTo("Durations.h", minutes(120)));
+    SHAREMIND_TESTASSERT(parsesTo("Durations.d", hours(48)));
+    SHAREMIND_TESTASSERT(parsesTo("Durations.ns", milliseconds(1)));
+    SHAREMIND_TESTASSERT(parsesTo("Durations.us", milliseconds(1)));
+    SHAREMIND_TESTASSERT(parsesTo("Durations.micro", milliseconds(1)));
+    SHAREMIND_TESTASSERT(parsesTo("Durations.micro", nanoseconds(1000000)));
+    SHAREMIND_TESTASSERT(parsesTo("Durations.Spaces", seconds(30)));
+
+    // Conversions which are not exact:
+    SHAREMIND_TESTASSERT(parsesTo("Durations.OneNs", nanoseconds(1)));
+    SHAREMIND_TESTASSERT(failsToParse<milliseconds>("Durations.OneNs"));
+    SHAREMIND_TESTASSERT(failsToParse<microseconds>("Durations.OneNs"));
+    SHAREMIND_TESTASSERT(failsToParse<milliseconds>("Durations.FractionalMs"));
+    SHAREMIND_TESTASSERT(failsToParse<hours>("Durations.min"));
+
+    // Overflows of the representation and of 64 bits:
+    SHAREMIND_TESTASSERT(parsesTo("Durations.MaxS", seconds::max()));
+    SHAREMIND_TESTASSERT(failsToParse<seconds>("Durations.AboveMaxS"));
+    SHAREMIND_TESTASSERT(failsToParse<milliseconds>("Durations.AboveRep"));
+    SHAREMIND_TESTASSERT(failsToParse<milliseconds>("Durations.Above64Bits"));
+
+    // Invalid durations:
+    SHAREMIND_TESTASSERT(failsToParse<milliseconds>("Durations.Negative"));
+    SHAREMIND_TESTASSERT(failsToParse<seconds>("Durations.Fractional"));
+    SHAREMIND_TESTASSERT(failsToParse<milliseconds>("Durations.OnlySuffix"));
+    SHAREMIND_TESTASSERT(failsToParse<seconds>("Durations.Unknown"));
+    SHAREMIND_TESTASSERT(failsToParse<milliseconds>("Durations.UpperCase"));
+}
+
+void testLists() {
+    using Ints = std::vector<std::int32_t>;
+    using Strings = std::vector<std::string>;
+
+    // Values with commas are split at commas, others at whitespace:
+    SHAREMIND_TESTASSERT(parsesTo("Lists.Commas", Ints{1, 2, 3}));
+    SHAREMIND_TESTASSERT(parsesTo("Lists.Whitespace", Ints{1, 2, 3}));
+    SHAREMIND_TESTASSERT(parsesTo("Lists.Single", Ints{42}));
+    SHAREMIND_TESTASSERT(
+            parsesTo("Lists.Mixed", Strings{"a b", "c\td", "e"}));
+    SHAREMIND_TESTASSERT(parsesTo("Lists.Whitespace",
+                                  Strings{"1", "2", "3"}));
+
+    // Elements separated by commas are trimmed, but may be empty:
+    SHAREMIND_TESTASSERT(
+            parsesTo("Lists.Padded", Strings{"a", "b c", "d"}));
+    SHAREMIND_TESTASSERT(parsesTo("Lists.EmptyElement",
+                                  Strings{"1", "", "2"}));
+    SHAREMIND_TESTASSERT(failsToParse<Ints>("Lists.EmptyElement"));
+    SHAREMIND_TESTASSERT(parsesTo("Lists.TrailingComma",
+                                  Strings{"1", "2", ""}));
+    SHAREMIND_TESTASSERT(parsesTo("Lists.OnlyComma", Strings{"", ""}));
+
+    // Values without elements:
+    SHAREMIND_TESTASSERT(parsesTo("Lists.Empty", Ints()));
+    SHAREMIND_TESTASSERT(parsesTo("Lists.Empty", Strings()));
+    SHAREMIND_TESTASSERT(parsesTo("Lists.WhitespaceOnly", Ints()));
+    SHAREMIND_TESTASSERT(parsesTo("Lists.WhitespaceOnly", Strings()));
+
+    // Elements are parsed like single values:
+    SHAREMIND_TESTASSERT(
+            parsesTo("Lists.Sizes",
+                     std::vector<ByteSize>{ByteSize(1024u),
+                                           ByteSize(2u << 20u)}));
+    SHAREMIND_TESTASSERT(failsToParse<std::vector<ByteSize> >(
+                             "Lists.SizesWithoutCommas"));
+    SHAREMIND_TESTASSERT(
+            parsesTo("Lists.Durations",
+                     std::vector<std::chrono::milliseconds>{
+                         std::chrono::milliseconds(1500),
+                         std::chrono::milliseconds(2000)}));
+    SHAREMIND_TESTASSERT(failsToParse<Ints>("Lists.Invalid"));
+    SHAREMIND_TESTASSERT(
+            failsToParse<std::vector<std::uint8_t> >("Lists.Overflow"));
+}
+
+} // anonymous namespace
+
+int main() {
+    char filename[] = "/tmp/TestValueParsing.XXXXXX";
+    {
+        auto const fd = ::mkstemp(filename);
+        SHAREMIND_TESTASSERT(fd >= 0);
+        ::close(fd);
+        std::ofstream f(filename);
+        f << "[Bytes]\n"
+             "Plain = 5\n"
+             "B = 5 B\n"
+             "K = 1 K\n"
+             "KiB = 1 KiB\n"
+             "kB = 1 kB\n"
+             "KB = 1 KB\n"
+             "MiB = 64 MiB\n"
+             "MB = 64 MB\n"
+             "GiB = 3GiB\n"
+             "TB = 2TB\n"
+             "Spaces = 64    MiB\n"
+             "Tab = 64\tK\n"
+             "NoSpace = 64MiB\n"
+             "Max = 18446744073709551615\n"
+             "MaxEiB = 15 EiB\n"
+             "MaxEB = 18 EB\n"
+             "AboveMax = 18446744073709551616\n"
+             "OverflowEiB = 16EiB\n"
+             "OverflowEB = 20EB\n"
+             "Negative = -1 KiB\n"
+             "Fractional = 1.5 KiB\n"
+             "OnlySuffix = KiB\n"
+             "LowerCase = 1 kib\n"
+             "Unknown = 1 XB\n"
+             "SplitSuffix = 1 K iB\n"
+             "Empty =\n"
+             "[Durations]\n"
+             "Plain = 5\n"
+             "ms = 1500 ms\n"
+             "s = 2 s\n"
+             "min = 90 min\n"
+             "h = 2h\n"
+             "d = 2 d\n"
+             "ns = 1000000 ns\n"
+             "us = 1000 us\n"
+             "micro = 1000 \xc2\xb5s\n"
+             "Spaces = 30 \t s\n"
+             "OneNs = 1ns\n"
+             "FractionalMs = 1500 us\n"
+             "MaxS = 9223372036854775807 s\n"
+             "AboveMaxS = 9223372036854775808 s\n"
+             "AboveRep = 200000000000 d\n"
+             "Above64Bits = 300000000000 d\n"
+             "Negative = -5 ms\n"
+             "Fractional = 1.5 s\n"
+             "OnlySuffix = ms\n"
+             "Unknown = 5 sec\n"
+             "UpperCase = 5 MS\n"
+             "[Lists]\n"
+             "Commas = 1,2,3\n"
+             "Whitespace = 1  2\t3\n"
+             "Single = 42\n"
+             "Mixed = a b, c\td ,e\n"
+             "Padded =  a ,\tb c\t,  d\n"
+             "EmptyElement = 1,,2\n"
+             "TrailingComma = 1, 2,\n"
+             "OnlyComma = ,\n"
+             "Empty =\n"
+             "WhitespaceOnly = %{Blank}\n"
+             "Sizes = 1 KiB, 2 MiB\n"
+             "SizesWithoutCommas = 1 KiB 2 MiB\n"
+             "Durations = 1500 ms, 2 s\n"
+             "Invalid = 1, two, 3\n"
+             "Overflow = 1 256\n";
+    }
+    // Values are trimmed when loaded, but not after interpolation:
+    auto const interpolation =
+            std::make_shared<Configuration::Interpolation>();
+    interpolation->addVariable("Blank", " \t\n ");
+    Configuration configuration(filename, interpolation);
+    ::unlink(filename);
+    conf = &configuration;
+
+    testByteSizes();
+    testDurations();
+    testLists();
+
+    // Cached parsed values equal those parsed anew:
+    configuration.setParsedValueCaching(true);
+    for (unsigned i = 0u; i < 2u; ++i) {
+        testByteSizes();
+        testDurations();
+        testLists();
+    }
+}